@@ -0,0 +1,187 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <sys/socket.h> // socket, connect, send, recv
+#include <sys/un.h> // sockaddr_un
+#include <unistd.h> // close
+
+#include <chrono>
+#include <cstring> // strncpy
+#include <iostream> // cin, cout, cerr
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Main.h"
+#include "../lib/Service.h"
+
+/**
+ * Sends queries to bin/server.bin, reading one per line from standard input,
+ * and prints each response as a line of its ID, status and results.
+ *
+ * Usage: bin/client.bin SOCKET [--window 64]
+ *
+ * Queries: ping | bfs SOURCE SINK | path SOURCE SINK | component NODE | neighbours NODE | stats
+ *
+ * Up to --window queries are sent before any response is awaited.
+ */
+
+namespace {
+
+bool parseRequest(const std::string& line, granky::Service::Request& request) {
+
+    std::istringstream in(line);
+    std::string op;
+    in >> op >> request.a >> request.b;
+
+    const std::pair<std::string_view, granky::Service::Op> ops[] = {
+        {"ping", granky::Service::PING},
+        {"bfs", granky::Service::BFS},
+        {"path", granky::Service::PATH},
+        {"component", granky::Service::COMPONENT},
+        {"neighbours", granky::Service::NEIGHBOURS},
+        {"stats", granky::Service::STATS},
+    };
+
+    for(const auto& [name, code] : ops) {
+
+        if(op == name) {
+
+            request.op = code;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+
+int main(int argc, const char** argv) {
+
+    size_t window = 64;
+
+    if(argc == 4 && std::string_view(argv[2]) == "--window") {
+
+        window = std::max(std::stoul(argv[3]), 1ul);
+    }
+    else if(argc != 2) {
+
+        std::cerr << "Usage: " << argv[0] << " SOCKET [--window 64]" << std::endl;
+        return 1;
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, argv[1], sizeof(address.sun_path) - 1);
+    const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(server < 0 || connect(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+
+        std::cerr << "Cannot connect to " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::string line;
+    std::string output;
+    std::string input;
+    uint32_t id = 0;
+    bool more = true;
+    const auto start = std::chrono::steady_clock::now();
+
+    while(more) {
+
+        size_t sent = 0;
+
+        // a window of queries goes out together, and its responses come back together
+        while(sent < window && (more = static_cast<bool>(std::getline(std::cin, line)))) {
+
+            granky::Service::Request request;
+
+            if(line.empty()) {
+
+                continue;
+            }
+
+            if(!parseRequest(line, request)) {
+
+                std::cerr << "Unknown query: " << line << std::endl;
+                continue;
+            }
+
+            request.id = ++id;
+            granky::Service::writeRequest(output, request);
+            ++sent;
+        }
+
+        for(size_t done = 0; done < output.size();) {
+
+            const auto got = send(server, output.data() + done, output.size() - done, MSG_NOSIGNAL);
+
+            if(got <= 0) {
+
+                std::cerr << "Lost the server" << std::endl;
+                return 1;
+            }
+
+            done += got;
+        }
+
+        output.clear();
+        granky::Service::Response response;
+        char buffer[1 << 16];
+
+        for(size_t received = 0; received < sent;) {
+
+            if(granky::Service::readResponse(input, response)) {
+
+                std::cout << response.id << " " << static_cast<int>(response.status);
+
+                for(const auto& [node, value] : response.results) {
+
+                    std::cout << " " << node << ":" << value;
+                }
+
+                std::cout << "\n";
+                ++received;
+                continue;
+            }
+
+            const auto got = recv(server, buffer, sizeof(buffer), 0);
+
+            if(got <= 0) {
+
+                std::cerr << "Lost the server" << std::endl;
+                return 1;
+            }
+
+            input.append(buffer, got);
+        }
+    }
+
+    const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout.flush();
+    std::cerr << id << " queries in " << seconds.count() << "s" << std::endl;
+    close(server);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <iostream> // cout, cerr
+#include <string_view>
+
+#include "Main.h"
+#include "../lib/CompressedGraph.h"
+#include "../lib/HashGraph.h"
+
+/**
+ * Compresses a .gky file into a CompressedGraph image, or describes an image.
+ *
+ * Usage: bin/compress.bin IN.gky OUT.gkc
+ *        bin/compress.bin --info IN.gkc
+ */
+
+void describe(const granky::CompressedGraph& graph) {
+
+    const auto flat = graph.getEdgeCount() * sizeof(granky::Graph::Edge);
+
+    std::cout << graph.getNodeCount() << " nodes, " << graph.getEdgeCount() << " edges, "
+        << graph.getBytes() << " bytes, " << graph.getBitsPerEdge() << " bits per edge ("
+        << (flat ? 100.0 * graph.getBytes() / flat : 0.0) << "% of a flat edge list)" << std::endl;
+}
+
+int main(int argc, const char** argv) {
+
+    if(argc != 3) {
+
+        std::cerr << "Usage: " << argv[0] << " IN.gky OUT.gkc | --info IN.gkc" << std::endl;
+        return 1;
+    }
+
+    granky::CompressedGraph graph;
+
+    if(std::string_view(argv[1]) == "--info") {
+
+        std::ifstream in(argv[2], std::ios::binary);
+
+        if(!graph.load(in)) {
+
+            std::cerr << "Not a compressed graph: " << argv[2] << std::endl;
+            return 1;
+        }
+
+        describe(graph);
+        return 0;
+    }
+
+    {
+        // the source graph is let go before the image is written
+        const auto source = granky::Graph::create<granky::HashGraph>(argv[1]);
+        graph.build(*source);
+    }
+
+    std::ofstream out(argv[2], std::ios::binary);
+    graph.save(out);
+    describe(graph);
+
+    return out ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <iostream> // cout, cerr
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Main.h"
+#include "../lib/Cluster.h"
+#include "../lib/Partition.h"
+
+/**
+ * Runs a search over shards written by bin/shard.bin, one local process per shard.
+ *
+ * Usage: bin/distribute.bin PREFIX bfs SOURCE
+ *        bin/distribute.bin PREFIX components
+ */
+
+int main(int argc, const char** argv) {
+
+    const std::string_view search(argc > 2 ? argv[2] : "");
+    granky::Partition partition;
+
+    if(!((search == "bfs" && argc == 4) || (search == "components" && argc == 3))) {
+
+        std::cerr << "Usage: " << argv[0] << " PREFIX bfs SOURCE | PREFIX components" << std::endl;
+        return 1;
+    }
+
+    if(!partition.read(argv[1])) {
+
+        std::cerr << "No partition at " << argv[1] << ".parts" << std::endl;
+        return 1;
+    }
+
+    const granky::Cluster cluster(partition.getShardCount());
+    std::vector<granky::Cluster::Summary> summaries;
+    const auto start = std::chrono::steady_clock::now();
+
+    const bool done = search == "bfs" ?
+            cluster.breadthFirst(argv[1], std::stol(argv[3]), summaries) :
+            cluster.colorComponents(argv[1], summaries);
+
+    const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+    if(!done) {
+
+        std::cerr << "A worker failed" << std::endl;
+        return 1;
+    }
+
+    for(size_t rank = 0; rank < summaries.size(); ++rank) {
+
+        const auto& each = summaries[rank];
+        std::cout << "worker " << rank << ": " << each.count << (search == "bfs" ? " reached, " : " components, ")
+            << each.messages << " messages, " << each.bytes << " bytes" << std::endl;
+    }
+
+    const auto total = granky::Cluster::combine(summaries);
+
+    if(search == "bfs") {
+
+        std::cout << total.count << " nodes reached, depth " << total.depth << ", mean distance "
+            << (total.count ? static_cast<double>(total.total) / total.count : 0.0) << std::endl;
+    }
+    else {
+
+        std::cout << total.count << " components among " << total.total << " nodes" << std::endl;
+    }
+
+    std::cout << total.rounds << " rounds, " << total.messages << " messages, " << total.bytes << " bytes sent, "
+        << seconds.count() << "s" << std::endl;
+
+    return 0;
+}
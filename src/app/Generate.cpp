@@ -0,0 +1,143 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <iostream> // cout, cerr
+#include <memory> // unique_ptr
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Main.h"
+#include "../lib/Generator.h"
+
+/**
+ * Writes a synthetic graph in .gky format.
+ *
+ * Usage: bin/generate.bin rmat SCALE EDGEFACTOR [options]
+ *        bin/generate.bin gnp NODES P [options]
+ *        bin/generate.bin grid ROWS COLUMNS [options]
+ *        bin/generate.bin chunglu NODES DEGREE EXPONENT [options]
+ *
+ * Options: [--seed 1] [--threads 0] [--weights MAX] [--out file]
+ */
+
+void usage(const char* name) {
+
+    std::cerr << "Usage: " << name << " rmat SCALE EDGEFACTOR | gnp NODES P | grid ROWS COLUMNS"
+        << " | chunglu NODES DEGREE EXPONENT" << std::endl
+        << "    [--seed 1] [--threads 0] [--weights MAX] [--out file]" << std::endl;
+}
+
+int main(int argc, const char** argv) {
+
+    std::vector<std::string> positional;
+    uint64_t seed = 1;
+    unsigned threads = 0;
+    unsigned weights = 0;
+    std::string out;
+
+    for(int i = 1; i < argc; ++i) {
+
+        const std::string_view flag(argv[i]);
+
+        if(flag.substr(0, 2) != "--") {
+
+            positional.emplace_back(flag);
+            continue;
+        }
+
+        if(i + 1 >= argc) {
+
+            usage(argv[0]);
+            return 1;
+        }
+
+        const std::string value(argv[++i]);
+
+        if(flag == "--seed") {
+
+            seed = std::stoull(value);
+        }
+        else if(flag == "--threads") {
+
+            threads = std::stoul(value);
+        }
+        else if(flag == "--weights") {
+
+            weights = std::stoul(value);
+        }
+        else if(flag == "--out") {
+
+            out = value;
+        }
+        else {
+
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::unique_ptr<granky::Generator> generator;
+    const auto kind = positional.empty() ? std::string() : positional[0];
+
+    if(kind == "rmat" && positional.size() == 3) {
+
+        generator = std::make_unique<granky::RMatGenerator>(
+                std::stoul(positional[1]), std::stoul(positional[2]), seed);
+    }
+    else if(kind == "gnp" && positional.size() == 3) {
+
+        generator = std::make_unique<granky::ErdosRenyiGenerator>(
+                std::stol(positional[1]), std::stod(positional[2]), seed);
+    }
+    else if(kind == "grid" && positional.size() == 3) {
+
+        generator = std::make_unique<granky::GridGenerator>(
+                std::stol(positional[1]), std::stol(positional[2]), seed);
+    }
+    else if(kind == "chunglu" && positional.size() == 4) {
+
+        generator = std::make_unique<granky::ChungLuGenerator>(
+                std::stol(positional[1]), std::stod(positional[2]), std::stod(positional[3]), seed);
+    }
+    else {
+
+        usage(argv[0]);
+        return 1;
+    }
+
+    generator->setMaxWeight(weights);
+
+    std::ofstream file;
+
+    if(!out.empty()) {
+
+        file.open(out, std::ios::binary);
+    }
+
+    std::ostream& stream = out.empty() ? std::cout : file;
+    std::ios::sync_with_stdio(false);
+    generator->write(stream, threads);
+    stream.flush();
+
+    return stream ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <fstream>
+#include <iostream> // cin, cout, cerr
+#include <string>
+#include <string_view>
+
+#include "Main.h"
+#include "../lib/ComponentTracker.h"
+#include "../lib/EdgeStream.h"
+#include "../lib/HashGraph.h"
+#include "../lib/MatrixGraph.h"
+#include "../lib/PathQuery.h"
+
+/**
+ * Builds a graph from a .gky stream as it arrives, reporting as it goes.
+ *
+ * Usage: bin/ingest.bin [FILE] [--backend hash|matrix] [--batch 1024] [--every 100000]
+ *                       [--millis 1000] [--source NODE --sink NODE]
+ *
+ * Reads standard input when no file is given, and a FIFO like any other file.
+ * Every round writes a line of statistics, with the number of components, which
+ * is kept up to date edge by edge, and with --source and --sink the length of
+ * the shortest path between them, which is found afresh.
+ */
+
+void usage(const char* name) {
+
+    std::cerr << "Usage: " << name << " [FILE] [--backend hash|matrix] [--batch 1024] [--every 100000]" << std::endl
+        << "    [--millis 1000] [--source NODE --sink NODE]" << std::endl;
+}
+
+int main(int argc, const char** argv) {
+
+    std::string filename;
+    std::string backend = "hash";
+    size_t batch = granky::EdgeStream::DEFAULT_BATCH_SIZE;
+    uint64_t every = 100000;
+    long millis = 1000;
+    granky::Graph::Node source = -1;
+    granky::Graph::Node sink = -1;
+
+    for(int i = 1; i < argc; ++i) {
+
+        const std::string_view flag(argv[i]);
+
+        if(flag.substr(0, 2) != "--") {
+
+            filename = flag;
+            continue;
+        }
+
+        if(i + 1 >= argc) {
+
+            usage(argv[0]);
+            return 1;
+        }
+
+        const std::string value(argv[++i]);
+
+        if(flag == "--backend") {
+
+            backend = value;
+        }
+        else if(flag == "--batch") {
+
+            batch = std::stoul(value);
+        }
+        else if(flag == "--every") {
+
+            every = std::stoull(value);
+        }
+        else if(flag == "--millis") {
+
+            millis = std::stol(value);
+        }
+        else if(flag == "--source") {
+
+            source = std::stoi(value);
+        }
+        else if(flag == "--sink") {
+
+            sink = std::stoi(value);
+        }
+        else {
+
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    granky::Graph::Instance graph;
+
+    if(backend == "hash") {
+
+        graph = granky::Graph::create<granky::HashGraph>();
+    }
+    else if(backend == "matrix") {
+
+        graph = granky::Graph::create<granky::MatrixGraph>();
+    }
+    else {
+
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream file;
+
+    if(!filename.empty()) {
+
+        file.open(filename);
+
+        if(!file) {
+
+            std::cerr << "Cannot open " << filename << std::endl;
+            return 1;
+        }
+    }
+
+    // unsynchronised, cin buffers, so the stream can tell when it has read all there is for now
+    std::ios::sync_with_stdio(false);
+    std::istream& in = filename.empty() ? std::cin : file;
+
+    granky::EdgeStream stream(*graph, batch);
+    granky::ComponentTracker components;
+    granky::AStar<granky::ZeroHeuristic> path;
+    const bool routed = graph->isNode(source) && graph->isNode(sink);
+
+    components.init(graph.get());
+
+    if(routed) {
+
+        path.setSource(source);
+        path.setSink(sink);
+        stream.addQuery(&path);
+    }
+
+    stream.setInterval(every, std::chrono::milliseconds(millis));
+
+    stream.setReport([&](const granky::EdgeStream::Stats& stats) {
+
+        std::cout << "t=" << stats.seconds << "s edges=" << stats.edges
+            << " rate=" << stats.getEdgesPerSecond() << "/s"
+            << " latency=" << stats.meanLatency * 1e3 << "ms max=" << stats.maxLatency * 1e3 << "ms"
+            << " nodes=" << graph->getNodeCount() << " components=" << components.getComponentCount();
+
+        if(routed) {
+
+            std::cout << " distance=" << path.yieldWeight();
+        }
+
+        std::cout << std::endl;
+    });
+
+    const auto stats = stream.run(in);
+
+    std::cout << "done: " << stats.lines << " lines, " << stats.edges << " edges in " << stats.batches
+        << " batches over " << stats.seconds << "s, " << stats.rounds << " rounds" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <poll.h> // poll
+#include <signal.h> // signal
+#include <sys/socket.h> // socket, bind, listen, accept, send, recv
+#include <sys/un.h> // sockaddr_un
+#include <unistd.h> // close, unlink
+
+#include <chrono>
+#include <cstring> // strncpy
+#include <iostream> // cout, cerr
+#include <memory> // unique_ptr
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Main.h"
+#include "../lib/CompressedGraph.h"
+#include "../lib/HashGraph.h"
+#include "../lib/Service.h"
+
+/**
+ * Loads a graph once and answers queries about it over a Unix domain socket,
+ * in the protocol of granky::Service, until interrupted.
+ *
+ * Usage: bin/server.bin IN.gky SOCKET [--threads 0] [--compressed]
+ *
+ * --compressed serves a CompressedGraph copy, letting the parsed graph go.
+ */
+
+namespace {
+
+volatile sig_atomic_t stopping = 0;
+
+void stop(int) {
+
+    stopping = 1;
+}
+
+struct Client {
+
+    int socket;
+    std::string input;
+    std::string output;
+};
+
+} // namespace
+
+int main(int argc, const char** argv) {
+
+    unsigned threads = 0;
+    bool compressed = false;
+
+    for(int i = 3; i < argc; ++i) {
+
+        const std::string_view flag(argv[i]);
+
+        if(flag == "--threads" && i + 1 < argc) {
+
+            threads = std::stoul(argv[++i]);
+        }
+        else if(flag == "--compressed") {
+
+            compressed = true;
+        }
+        else {
+
+            argc = 0;
+        }
+    }
+
+    if(argc < 3) {
+
+        std::cerr << "Usage: " << argv[0] << " IN.gky SOCKET [--threads 0] [--compressed]" << std::endl;
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    granky::Graph::Instance graph = granky::Graph::create<granky::HashGraph>(argv[1]);
+
+    if(compressed) {
+
+        graph = std::make_unique<granky::CompressedGraph>(*graph);
+    }
+
+    granky::Service service(*graph, threads);
+    const std::chrono::duration<double> loading = std::chrono::steady_clock::now() - start;
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if(strlen(argv[2]) >= sizeof(address.sun_path)) {
+
+        std::cerr << "Socket path too long: " << argv[2] << std::endl;
+        return 1;
+    }
+
+    strncpy(address.sun_path, argv[2], sizeof(address.sun_path) - 1);
+    unlink(argv[2]);
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+
+    if(listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+
+        std::cerr << "Cannot listen on " << argv[2] << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Serving " << graph->getNodeCount() << " nodes and " << graph->getEdgeCount() << " edges on "
+        << argv[2] << ", loaded in " << loading.count() << "s" << std::endl;
+
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<pollfd> polls;
+    char buffer[1 << 16];
+
+    while(!stopping) {
+
+        polls.assign(1, {listener, POLLIN, 0});
+
+        for(const auto& each : clients) {
+
+            polls.push_back({each->socket, static_cast<short>(each->output.empty() ? POLLIN : POLLIN | POLLOUT), 0});
+        }
+
+        if(poll(polls.data(), polls.size(), -1) < 0) {
+
+            continue;
+        }
+
+        for(size_t i = clients.size(); i > 0; --i) {
+
+            auto& client = *clients[i - 1];
+            const auto events = polls[i].revents;
+            bool open = true;
+
+            // everything waiting is read, so that requests sent together are answered as a batch
+            if(events & (POLLIN | POLLHUP | POLLERR)) {
+
+                ssize_t got;
+
+                while((got = recv(client.socket, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+
+                    client.input.append(buffer, got);
+                }
+
+                open = (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) && service.serve(client.input, client.output);
+            }
+
+            while(open && !client.output.empty()) {
+
+                const auto sent = send(client.socket, client.output.data(), client.output.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+
+                if(sent <= 0) {
+
+                    open = sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+                    break;
+                }
+
+                client.output.erase(0, sent);
+            }
+
+            if(!open) {
+
+                close(client.socket);
+                clients.erase(clients.begin() + (i - 1));
+            }
+        }
+
+        if(polls[0].revents & POLLIN) {
+
+            for(int socket; (socket = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK)) >= 0;) {
+
+                clients.emplace_back(new Client{socket, {}, {}});
+            }
+        }
+    }
+
+    for(const auto& each : clients) {
+
+        close(each->socket);
+    }
+
+    close(listener);
+    unlink(argv[2]);
+
+    const auto stats = service.getStats();
+    std::cout << stats.requests << " requests in " << stats.batches << " batches; latency median "
+        << stats.median << "us, p90 " << stats.p90 << "us, p99 " << stats.p99 << "us, max " << stats.max << "us" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <charconv> // from_chars
+#include <iostream> // cout, cerr
+#include <string>
+#include <string_view>
+
+#include "Main.h"
+#include "../lib/HashGraph.h"
+#include "../lib/Partition.h"
+
+/**
+ * Splits a .gky file into shards for bin/distribute.bin.
+ *
+ * Usage: bin/shard.bin IN.gky SHARDS PREFIX [--method ldg|fennel|hash]
+ *
+ * Writes PREFIX.parts and PREFIX.0.gky to PREFIX.(SHARDS - 1).gky.
+ */
+
+int main(int argc, const char** argv) {
+
+    std::string method = "ldg";
+
+    if(argc == 6 && std::string_view(argv[4]) == "--method") {
+
+        method = argv[5];
+    }
+    else if(argc != 4) {
+
+        std::cerr << "Usage: " << argv[0] << " IN.gky SHARDS PREFIX [--method ldg|fennel|hash]" << std::endl;
+        return 1;
+    }
+
+    const std::string_view count(argv[2]);
+    granky::Graph::Node shards = 0;
+
+    if(const auto parsed = std::from_chars(count.data(), count.data() + count.size(), shards);
+        parsed.ec != std::errc() || parsed.ptr != count.data() + count.size() || shards < 1) {
+
+        std::cerr << "SHARDS must be a whole number of at least 1: " << argv[2] << std::endl;
+        return 1;
+    }
+
+    const auto graph = granky::Graph::create<granky::HashGraph>(argv[1]);
+    granky::Partition partition;
+
+    if(method == "ldg") {
+
+        partition = granky::Partition::byLDG(*graph, shards);
+    }
+    else if(method == "fennel") {
+
+        partition = granky::Partition::byFennel(*graph, shards);
+    }
+    else if(method == "hash") {
+
+        partition = granky::Partition::byHash(*graph, shards);
+    }
+    else {
+
+        std::cerr << "Unknown method: " << method << std::endl;
+        return 1;
+    }
+
+    if(!partition.write(*graph, argv[3])) {
+
+        std::cerr << "Could not write shards to " << argv[3] << std::endl;
+        return 1;
+    }
+
+    const auto cut = partition.getEdgeCut(*graph);
+    const auto edges = graph->getEdgeCount();
+
+    for(granky::Graph::Node shard = 0; shard < partition.getShardCount(); ++shard) {
+
+        std::cout << granky::Partition::getShardFile(argv[3], shard) << ": " << partition.getSize(shard) << " nodes" << std::endl;
+    }
+
+    std::cout << cut << " of " << edges << " edges cut (" << (edges ? 100.0 * cut / edges : 0.0) << "%)" << std::endl;
+    return 0;
+}
@@ -19,12 +19,14 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <fstream>
 #include <iostream> // cout
 #include <string> // string_view
 
 #include "Main.h"
 #include "../lib/MatrixGraph.h"
 #include "../lib/HashGraph.h"
+#include "../lib/Trace.h"
 
 void writeGraph(granky::Graph::Instance& graph) {
 
@@ -90,13 +92,18 @@ void writeEgresses(granky::Graph::Instance& matrixGraph, granky::Graph::Instance
 
 int main(int argc, const char** argv) {
 
-    if(argc < 2) {
+    if(argc != 2 && (argc != 4 || std::string_view(argv[2]) != "--trace")) {
 
-        std::cout << "Expected input file" << std::endl;
+        std::cout << "Expected input file, optionally followed by --trace output.json" << std::endl;
         return 1;
     }
 
     const std::string_view filename(argv[1]);
+
+    if(argc == 4) {
+
+        granky::Trace::enable();
+    }
     
     std::cout << "Graph as matrix:" << std::endl;
 
@@ -111,5 +118,11 @@ int main(int argc, const char** argv) {
     writeNodes(matrixGraph, hashGraph);
     writeEgresses(matrixGraph, hashGraph);
 
+    if(argc == 4) {
+
+        std::ofstream trace(argv[3]);
+        granky::Trace::write(trace);
+    }
+
     return 0;
 }
@@ -0,0 +1,720 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <sys/resource.h> // getrusage
+
+#include <algorithm> // sort
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory> // unique_ptr
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits> // is_same
+#include <vector>
+
+#include "../lib/BatchQuery.h"
+#include "../lib/BitGraph.h"
+#include "../lib/ComponentTracker.h"
+#include "../lib/CompressedGraph.h"
+#include "../lib/ContractionHierarchy.h"
+#include "../lib/DynamicShortestPaths.h"
+#include "../lib/Executor.h"
+#include "../lib/Generator.h"
+#include "../lib/HashGraph.h"
+#include "../lib/MatrixGraph.h"
+#include "../lib/PathQuery.h"
+#include "../lib/Permutation.h"
+#include "../lib/Query.h"
+#include "../lib/QueryCache.h"
+#include "../lib/ReachabilityIndex.h"
+#include "../lib/ShardedGraph.h"
+#include "../lib/Trace.h"
+
+/**
+ * Times the library on synthetic graphs, for comparison between commits.
+ *
+ * Usage: bin/bench.bin [--format json|csv] [--sizes 256,1024] [--degrees 4,16]
+ *                      [--reps 5] [--warmup 1] [--seed 1] [--out file] [--trace file]
+ *
+ * Every case is run warmup times untimed and reps times timed, and the median
+ * is reported along with edges per second, nanoseconds per edge and the peak
+ * resident set size of the process so far. --trace writes the spans of the
+ * last run of every case as Chrome trace-event JSON.
+ */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const size_t CONTRACTION_LIMIT = 4096;
+
+struct Options {
+
+    std::string format = "json";
+    std::vector<long> sizes = {256, 1024, 2048};
+    std::vector<long> degrees = {4, 16};
+    long reps = 5;
+    long warmup = 1;
+    long seed = 1;
+    std::string out;
+    std::string trace;
+};
+
+struct Row {
+
+    std::string name;
+    std::string backend;
+    long nodes;
+    long degree;
+    size_t edges;
+    double median;
+};
+
+std::vector<long> parseList(const std::string_view text) {
+
+    std::vector<long> ret;
+    std::stringstream stream(std::string(text.data(), text.size()));
+
+    for(std::string each; std::getline(stream, each, ',');) {
+
+        ret.push_back(std::stol(each));
+    }
+
+    return ret;
+}
+
+bool parseOptions(int argc, const char** argv, Options& options) {
+
+    for(int i = 1; i < argc; ++i) {
+
+        const std::string_view flag(argv[i]);
+
+        if(i + 1 >= argc) {
+
+            return false;
+        }
+
+        const std::string_view value(argv[++i]);
+
+        if(flag == "--format") {
+
+            options.format = value;
+        }
+        else if(flag == "--sizes") {
+
+            options.sizes = parseList(value);
+        }
+        else if(flag == "--degrees") {
+
+            options.degrees = parseList(value);
+        }
+        else if(flag == "--reps") {
+
+            options.reps = std::stol(std::string(value));
+        }
+        else if(flag == "--warmup") {
+
+            options.warmup = std::stol(std::string(value));
+        }
+        else if(flag == "--seed") {
+
+            options.seed = std::stol(std::string(value));
+        }
+        else if(flag == "--out") {
+
+            options.out = value;
+        }
+        else if(flag == "--trace") {
+
+            options.trace = value;
+        }
+        else {
+
+            return false;
+        }
+    }
+
+    return options.reps > 0 && (options.format == "json" || options.format == "csv");
+}
+
+long peakKilobytes() {
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Runs a case and returns its median time in nanoseconds.
+ * Setup runs before every repetition, untimed.
+ */
+double measure(const Options& options, const std::function<void()>& setup, const std::function<void()>& run) {
+
+    std::vector<double> times;
+
+    for(long i = 0; i < options.warmup + options.reps; ++i) {
+
+        // every run but the last is left out of the trace
+        if(!options.trace.empty()) {
+
+            if(i + 1 < options.warmup + options.reps) {
+
+                granky::Trace::disable();
+            }
+            else {
+
+                granky::Trace::enable();
+            }
+        }
+
+        setup();
+        const auto start = Clock::now();
+        run();
+        const auto stop = Clock::now();
+
+        if(i >= options.warmup) {
+
+            times.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+class Writer {
+
+public:
+    Writer(std::ostream& o, const std::string& f) : out(o), format(f) {
+
+        if(format == "csv") {
+
+            out << "name,backend,nodes,degree,edges,median_ns,edges_per_second,ns_per_edge,peak_rss_kb" << std::endl;
+        }
+        else {
+
+            out << "[" << std::endl;
+        }
+    }
+
+    ~Writer() {
+
+        if(format != "csv") {
+
+            out << std::endl << "]" << std::endl;
+        }
+    }
+
+    void write(const Row& row) {
+
+        const auto edges = static_cast<double>(row.edges);
+        const auto perSecond = row.median > 0 ? edges / (row.median / 1e9) : 0.0;
+        const auto perEdge = edges > 0 ? row.median / edges : 0.0;
+        const auto peak = peakKilobytes();
+
+        if(format == "csv") {
+
+            out << row.name << "," << row.backend << "," << row.nodes << "," << row.degree << ","
+                << row.edges << "," << row.median << "," << perSecond << "," << perEdge << ","
+                << peak << std::endl;
+            return;
+        }
+
+        out << (first ? "" : ",\n")
+            << "  {\"name\": \"" << row.name << "\", \"backend\": \"" << row.backend << "\""
+            << ", \"nodes\": " << row.nodes << ", \"degree\": " << row.degree
+            << ", \"edges\": " << row.edges << ", \"median_ns\": " << row.median
+            << ", \"edges_per_second\": " << perSecond << ", \"ns_per_edge\": " << perEdge
+            << ", \"peak_rss_kb\": " << peak << "}";
+        first = false;
+    }
+
+private:
+    std::ostream& out;
+    const std::string format;
+    bool first = true;
+};
+
+template<class GRAPH_TYPE>
+void benchBackend(const Options& options, Writer& writer, const std::string& backend, const long nodes, const long degree) {
+
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<granky::Graph::Node> pick(0, nodes - 1);
+    std::uniform_int_distribution<int> weigh(1, 100);
+    std::stringstream text;
+
+    for(long i = 0; i < nodes * degree; ++i) {
+
+        text << pick(random) << " " << pick(random) << " " << weigh(random) << "\n";
+    }
+
+    const auto source = text.str();
+    auto graph = granky::Graph::create<GRAPH_TYPE>();
+    graph->parseString(source);
+    const auto edges = graph->getEdgeCount();
+    const auto list = graph->getEdges();
+
+    const auto report = [&](const std::string& name, const double median) {
+
+        writer.write({name, backend, nodes, degree, edges, median});
+    };
+
+    const auto none = []() {};
+    granky::Graph::Instance scratch;
+
+    report("parse", measure(options, [&]() { scratch = granky::Graph::create<GRAPH_TYPE>(); }, [&]() {
+
+        scratch->parseString(source);
+    }));
+
+    report("addEdge", measure(options, [&]() { scratch = granky::Graph::create<GRAPH_TYPE>(); }, [&]() {
+
+        for(const auto& each : list) {
+
+            scratch->addEdge(each.from, each.to, each.weight);
+        }
+    }));
+
+    granky::Graph::Weight sink = 0.0;
+
+    const granky::Graph::ProgressCall sum = [&sink](granky::Graph::Node, granky::Graph::Weight weight) {
+
+        sink += weight;
+        return -1;
+    };
+
+    report("forEachEgress", measure(options, none, [&]() {
+
+        for(granky::Graph::Node each = 0; each < nodes; ++each) {
+
+            graph->forEachEgress(each, sum);
+        }
+    }));
+
+    report("forEachIngress", measure(options, none, [&]() {
+
+        for(granky::Graph::Node each = 0; each < nodes; ++each) {
+
+            graph->forEachIngress(each, sum);
+        }
+    }));
+
+    report("getEdges", measure(options, none, [&]() {
+
+        const auto got = graph->getEdges();
+        sink += got.empty() ? 0 : 1;
+    }));
+
+    const granky::Graph::BlockCall blockCall = [&sink](const granky::Graph::EdgeList& block) {
+
+        sink += block.size();
+        return -1;
+    };
+
+    report("forEachEdgeBlock", measure(options, none, [&]() {
+
+        graph->forEachEdgeBlock(blockCall);
+    }));
+
+    if constexpr(std::is_same<GRAPH_TYPE, granky::BitGraph>::value) {
+
+        const auto bits = static_cast<const granky::BitGraph*>(graph.get());
+
+        report("countCommonDigresses", measure(options, none, [&]() {
+
+            for(granky::Graph::Node each = 0; each < nodes; ++each) {
+
+                sink += bits->countCommonDigresses(each, nodes - 1 - each);
+            }
+        }));
+
+        report("countTriangles", measure(options, none, [&]() {
+
+            sink += bits->countTriangles();
+        }));
+    }
+
+    auto copy = granky::Graph::create<GRAPH_TYPE>();
+    copy->parseString(source);
+
+    report("operator==", measure(options, none, [&]() {
+
+        sink += *graph == *copy ? 1 : 0;
+    }));
+
+    const auto runQuery = [&](const std::string& name, granky::Query& query, const bool init) {
+
+        query.setSource(0);
+        query.setSink(nodes - 1);
+
+        if(!init) {
+
+            query.init(graph.get());
+        }
+
+        report(name, measure(options, [&]() { if(init) query.init(graph.get()); }, [&]() {
+
+            query.execute();
+        }));
+    };
+
+    granky::RecursiveDFS dfs;
+    runQuery("RecursiveDFS", dfs, true);
+
+    granky::RecursiveDigraphDFS digraphDfs;
+    runQuery("RecursiveDigraphDFS", digraphDfs, true);
+
+    granky::ColorComponents colors;
+    runQuery("ColorComponents", colors, true);
+
+    granky::AStar<granky::ZeroHeuristic> astar;
+    runQuery("AStar", astar, false);
+
+    granky::BidirectionalDijkstra bidirectional;
+    runQuery("BidirectionalDijkstra", bidirectional, false);
+
+    granky::MultiSourceBFS bfs;
+
+    for(granky::Graph::Node each = 0; each < std::min<long>(nodes, 256); ++each) {
+
+        bfs.addSource(each);
+    }
+
+    bfs.keepDistances(false);
+    runQuery("MultiSourceBFS", bfs, false);
+
+    granky::ComponentTracker tracker;
+    runQuery("ComponentTracker", tracker, false);
+
+    granky::DynamicShortestPaths dynamic;
+    runQuery("DynamicShortestPaths", dynamic, true);
+
+    granky::QueryCache cache;
+    granky::AStar<granky::ZeroHeuristic> cached;
+    cached.init(graph.get());
+    cached.setSource(0);
+    cached.setSink(nodes - 1);
+    cache.execute(cached);
+
+    report("QueryCache(hit)", measure(options, none, [&]() {
+
+        cache.execute(cached);
+    }));
+
+    // contraction is far from linear on random graphs, which have no hierarchy to find
+    if(edges <= CONTRACTION_LIMIT) {
+
+        granky::ContractionHierarchy hierarchy;
+
+        report("ContractionHierarchy::build", measure(options, none, [&]() {
+
+            hierarchy.build(*graph);
+        }));
+
+        granky::HierarchyQuery hierarchyQuery(hierarchy);
+        runQuery("HierarchyQuery", hierarchyQuery, false);
+    }
+
+    granky::ReachabilityIndex reachability;
+
+    report("ReachabilityIndex::build", measure(options, none, [&]() {
+
+        reachability.build(*graph);
+    }));
+
+    report("ReachabilityIndex::canReach", measure(options, none, [&]() {
+
+        for(granky::Graph::Node each = 0; each < nodes; ++each) {
+
+            sink += reachability.canReach(each, nodes - 1 - each) ? 1 : 0;
+        }
+    }));
+
+    if(!isfinite(sink)) {
+
+        std::cerr << "unexpected checksum" << std::endl;
+    }
+}
+
+/**
+ * Times building a CompressedGraph from a HashGraph, and decoding its lists.
+ */
+void benchCompressed(const Options& options, Writer& writer, const long nodes, const long degree) {
+
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<granky::Graph::Node> pick(0, nodes - 1);
+    std::uniform_int_distribution<int> weigh(1, 100);
+    auto source = granky::Graph::create<granky::HashGraph>();
+
+    for(long i = 0; i < nodes * degree; ++i) {
+
+        source->addEdge(pick(random), pick(random), weigh(random));
+    }
+
+    const auto edges = source->getEdgeCount();
+    granky::CompressedGraph graph;
+    granky::Graph::Weight sink = 0.0;
+
+    const granky::Graph::ProgressCall sum = [&sink](granky::Graph::Node, granky::Graph::Weight weight) {
+
+        sink += weight;
+        return -1;
+    };
+
+    const auto report = [&](const std::string& name, const double median) {
+
+        writer.write({name, "CompressedGraph", nodes, degree, edges, median});
+    };
+
+    report("build", measure(options, []() {}, [&]() {
+
+        graph.build(*source);
+    }));
+
+    report("forEachEgress", measure(options, []() {}, [&]() {
+
+        for(granky::Graph::Node each = 0; each < nodes; ++each) {
+
+            graph.forEachEgress(each, sum);
+        }
+    }));
+
+    report("forEachIngress", measure(options, []() {}, [&]() {
+
+        for(granky::Graph::Node each = 0; each < nodes; ++each) {
+
+            graph.forEachIngress(each, sum);
+        }
+    }));
+
+    if(!isfinite(sink)) {
+
+        std::cerr << "unexpected checksum" << std::endl;
+    }
+}
+
+/**
+ * Times each reordering of a power-law graph under shuffled IDs, and a
+ * multi-source BFS over a CompressedGraph of the graph as each leaves it.
+ */
+void benchReordering(const Options& options, Writer& writer, const long nodes, const long degree) {
+
+    auto base = granky::Graph::create<granky::HashGraph>();
+    granky::ChungLuGenerator(nodes, degree, 2.5, options.seed).generate(*base, 1);
+
+    std::vector<granky::Graph::Node> order;
+
+    base->forEachNode([&order](granky::Graph::Node node) -> granky::Graph::Node {
+
+        order.push_back(node);
+        return -1;
+    });
+
+    std::sort(order.begin(), order.end());
+    std::shuffle(order.begin(), order.end(), std::mt19937(options.seed));
+    const auto shuffled = granky::Permutation(order).relabel<granky::HashGraph>(*base);
+    const auto edges = shuffled->getEdgeCount();
+
+    const auto report = [&](const std::string& name, const double median) {
+
+        writer.write({name, "CompressedGraph", nodes, degree, edges, median});
+    };
+
+    // the sources are the same nodes under every labelling
+    const auto traverse = [&](const std::string& name, const granky::Graph& source, const granky::Permutation* permutation) {
+
+        granky::CompressedGraph graph(source);
+        granky::MultiSourceBFS bfs;
+
+        for(granky::Graph::Node each = 0; each < std::min<long>(nodes, 64); ++each) {
+
+            bfs.addSource(permutation ? permutation->translate(each) : each);
+        }
+
+        bfs.keepDistances(false);
+        bfs.init(&graph);
+
+        report("MultiSourceBFS(" + name + ")", measure(options, []() {}, [&]() {
+
+            bfs.execute();
+        }));
+    };
+
+    traverse("shuffled", *shuffled, nullptr);
+
+    const std::pair<std::string, std::function<granky::Permutation(const granky::Graph&)>> orderings[] = {
+        {"byDegree", granky::Permutation::byDegree},
+        {"byCuthillMcKee", granky::Permutation::byCuthillMcKee},
+        {"byCommunity", granky::Permutation::byCommunity},
+    };
+
+    for(const auto& [name, reorder] : orderings) {
+
+        granky::Permutation permutation;
+
+        report("Permutation::" + name, measure(options, []() {}, [&]() {
+
+            permutation = reorder(*shuffled);
+        }));
+
+        traverse(name, *permutation.relabel<granky::HashGraph>(*shuffled), &permutation);
+    }
+}
+
+/**
+ * Times concurrent ingestion into a ShardedGraph, each thread adding an equal share of the edges.
+ */
+void benchSharded(const Options& options, Writer& writer, const long nodes, const long degree) {
+
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<granky::Graph::Node> pick(0, nodes - 1);
+    std::uniform_int_distribution<int> weigh(1, 100);
+    granky::Graph::EdgeList list;
+
+    for(long i = 0; i < nodes * degree; ++i) {
+
+        list.push_back({pick(random), pick(random), static_cast<granky::Graph::Weight>(weigh(random))});
+    }
+
+    std::unique_ptr<granky::ShardedGraph> scratch;
+
+    for(const unsigned threads : {1u, 2u, 4u}) {
+
+        const auto median = measure(options, [&]() { scratch.reset(new granky::ShardedGraph()); }, [&]() {
+
+            std::vector<std::thread> workers;
+
+            for(unsigned i = 0; i < threads; ++i) {
+
+                workers.emplace_back([&list, &scratch, threads, i]() {
+
+                    for(size_t each = i; each < list.size(); each += threads) {
+
+                        scratch->addEdge(list[each].from, list[each].to, list[each].weight);
+                    }
+                });
+            }
+
+            for(auto& each : workers) {
+
+                each.join();
+            }
+        });
+
+        writer.write({"addEdge(" + std::to_string(threads) + " threads)", "ShardedGraph", nodes, degree, scratch->getEdgeCount(), median});
+    }
+}
+
+/**
+ * Times a batch of independent shortest path searches on one HashGraph, run by Executors of 1, 2 and 4 threads.
+ */
+void benchExecutor(const Options& options, Writer& writer, const long nodes, const long degree) {
+
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<granky::Graph::Node> pick(0, nodes - 1);
+    std::uniform_int_distribution<int> weigh(1, 100);
+    auto graph = granky::Graph::create<granky::HashGraph>();
+
+    for(long i = 0; i < nodes * degree; ++i) {
+
+        graph->addEdge(pick(random), pick(random), weigh(random));
+    }
+
+    std::vector<granky::AStar<granky::ZeroHeuristic>> searches(64);
+    std::vector<granky::Query*> batch;
+
+    for(auto& each : searches) {
+
+        each.setSource(pick(random));
+        each.setSink(pick(random));
+        batch.push_back(&each);
+    }
+
+    for(const unsigned threads : {1u, 2u, 4u}) {
+
+        granky::Executor executor(threads);
+
+        const auto median = measure(options, []() {}, [&]() {
+
+            for(auto& each : executor.submit(batch, *graph)) {
+
+                each.wait();
+            }
+        });
+
+        writer.write({"AStar x64(" + std::to_string(threads) + " threads)", "Executor", nodes, degree, graph->getEdgeCount(), median});
+    }
+}
+
+} // namespace
+
+int main(int argc, const char** argv) {
+
+    Options options;
+
+    if(!parseOptions(argc, argv, options)) {
+
+        std::cout << "Usage: " << argv[0]
+            << " [--format json|csv] [--sizes 256,1024] [--degrees 4,16]"
+            << " [--reps 5] [--warmup 1] [--seed 1] [--out file] [--trace file]" << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+
+    if(!options.out.empty()) {
+
+        file.open(options.out);
+    }
+
+    std::ostream& out = options.out.empty() ? std::cout : file;
+
+    {
+        Writer writer(out, options.format);
+
+        for(const auto nodes : options.sizes) {
+
+            for(const auto degree : options.degrees) {
+
+                benchBackend<granky::MatrixGraph>(options, writer, "MatrixGraph", nodes, degree);
+                benchBackend<granky::HashGraph>(options, writer, "HashGraph", nodes, degree);
+                benchBackend<granky::BitGraph>(options, writer, "BitGraph", nodes, degree);
+                benchSharded(options, writer, nodes, degree);
+                benchCompressed(options, writer, nodes, degree);
+                benchReordering(options, writer, nodes, degree);
+                benchExecutor(options, writer, nodes, degree);
+            }
+        }
+    }
+
+    if(!options.trace.empty()) {
+
+        std::ofstream trace(options.trace);
+        granky::Trace::write(trace);
+    }
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+
+#include <algorithm> // min
+
+#include "BatchQuery.h"
+
+namespace granky {
+
+namespace {
+
+/**
+ * One bit per concurrent search. The word loops are left plain so that the
+ * compiler can turn them into vector instructions when WORDS > 1.
+ */
+template<size_t WORDS>
+struct Lanes {
+
+    uint64_t word[WORDS] = {};
+
+    inline bool any() const {
+
+        uint64_t ret = 0;
+
+        for(size_t i = 0; i < WORDS; ++i) {
+
+            ret |= word[i];
+        }
+
+        return ret != 0;
+    }
+
+    inline void clear() {
+
+        for(size_t i = 0; i < WORDS; ++i) {
+
+            word[i] = 0;
+        }
+    }
+
+    inline void set(const size_t bit) {
+
+        word[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+
+    inline Lanes& operator |= (const Lanes& other) {
+
+        for(size_t i = 0; i < WORDS; ++i) {
+
+            word[i] |= other.word[i];
+        }
+
+        return *this;
+    }
+
+    /**
+     * this & ~other
+     */
+    inline Lanes without(const Lanes& other) const {
+
+        Lanes ret;
+
+        for(size_t i = 0; i < WORDS; ++i) {
+
+            ret.word[i] = word[i] & ~other.word[i];
+        }
+
+        return ret;
+    }
+};
+
+} // namespace
+
+void MultiSourceBFS::addSource(const Graph::Node s) {
+
+    sources.push_back(s);
+}
+
+void MultiSourceBFS::clearSources() {
+
+    sources.clear();
+}
+
+void MultiSourceBFS::keepDistances(const bool k) {
+
+    keep = k;
+}
+
+void MultiSourceBFS::init(Graph* g) {
+
+    GRANKY_PHASE("init");
+    assert(g);
+    graph = g;
+}
+
+void MultiSourceBFS::execute() {
+
+    GRANKY_PHASE("execute");
+    GRANKY_TRACE("MultiSourceBFS::execute");
+    cachedTable.reset();
+    assert(graph);
+
+    const auto end = static_cast<size_t>(graph->getEndNode());
+
+    node = static_cast<Graph::Node>(sources.size());
+    weight = 0.0;
+    distances.assign(keep ? sources.size() * end : 0, -1);
+    closeness.assign(sources.size(), 0.0);
+
+    for(size_t first = 0; first < sources.size(); first += LANES) {
+
+        const auto count = std::min(LANES, sources.size() - first);
+
+        if(count <= 64) {
+
+            run<1>(first, count);
+        }
+        else {
+
+            run<LANES / 64>(first, count);
+        }
+    }
+}
+
+Graph::Node MultiSourceBFS::yieldDistance(const size_t index, const Graph::Node n) const {
+
+    assert(keep && index < sources.size() && Graph::isNode(n));
+    const auto end = distances.size() / sources.size();
+    return static_cast<size_t>(n) < end ? distances[index * end + n] : -1;
+}
+
+Graph::Weight MultiSourceBFS::yieldCloseness(const size_t index) const {
+
+    assert(index < sources.size());
+    return closeness[index];
+}
+
+std::shared_ptr<const Query::Extra> MultiSourceBFS::saveExtra() const {
+
+    auto ret = std::make_shared<Results>();
+    ret->distances = distances;
+    ret->closeness = closeness;
+    return ret;
+}
+
+void MultiSourceBFS::restoreExtra(const Extra& extra) {
+
+    const auto& results = static_cast<const Results&>(extra);
+    distances = results.distances;
+    closeness = results.closeness;
+}
+
+template<size_t WORDS>
+void MultiSourceBFS::run(const size_t first, const size_t count) {
+
+    const auto end = static_cast<size_t>(graph->getEndNode());
+
+    std::vector<Lanes<WORDS>> seen(end);
+    std::vector<Lanes<WORDS>> visit(end);
+    std::vector<Lanes<WORDS>> next(end);
+    std::vector<Graph::Node> frontier;
+    std::vector<Graph::Node> touched;
+    std::vector<Graph::Node> reached(count, 0);
+    std::vector<uint64_t> farness(count, 0);
+    Graph::Node current = -1;
+
+    for(size_t i = 0; i < count; ++i) {
+
+        const auto s = sources[first + i];
+
+        if(!graph->haveNode(s)) {
+
+            continue;
+        }
+
+        if(!visit[s].any()) {
+
+            frontier.push_back(s);
+        }
+
+        seen[s].set(i);
+        visit[s].set(i);
+        reached[i] = 1;
+
+        if(keep) {
+
+            distances[(first + i) * end + s] = 0;
+        }
+    }
+
+    const Graph::ProgressCall callback = [&](Graph::Node to, Graph::Weight) {
+
+        GRANKY_STAT(examined, 1);
+        GRANKY_STAT(callbacks, 1);
+        const auto fresh = visit[current].without(seen[to]);
+
+        if(fresh.any()) {
+
+            if(!next[to].any()) {
+
+                touched.push_back(to);
+            }
+
+            next[to] |= fresh;
+        }
+
+        return -1;
+    };
+
+    for(Graph::Node depth = 1; !frontier.empty(); ++depth) {
+
+        for(const auto each : frontier) {
+
+            current = each;
+            GRANKY_STAT(visited, 1);
+            graph->forEachEgress(each, callback);
+        }
+
+        for(const auto each : frontier) {
+
+            visit[each].clear();
+        }
+
+        frontier.clear();
+
+        for(const auto each : touched) {
+
+            const auto fresh = next[each].without(seen[each]);
+            next[each].clear();
+
+            if(!fresh.any()) {
+
+                continue;
+            }
+
+            seen[each] |= fresh;
+            visit[each] = fresh;
+            frontier.push_back(each);
+
+            for(size_t w = 0; w < WORDS; ++w) {
+
+                for(auto bits = fresh.word[w]; bits; bits &= bits - 1) {
+
+                    const auto i = w * 64 + __builtin_ctzll(bits);
+                    ++reached[i];
+                    farness[i] += depth;
+
+                    if(keep) {
+
+                        distances[(first + i) * end + each] = depth;
+                    }
+                }
+            }
+        }
+
+        touched.clear();
+    }
+
+    for(size_t i = 0; i < count; ++i) {
+
+        weight += farness[i];
+        closeness[first + i] = farness[i] ? (reached[i] - 1) / static_cast<Graph::Weight>(farness[i]) : 0.0;
+    }
+}
+
+} // namespace granky
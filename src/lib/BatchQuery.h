@@ -0,0 +1,89 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_BATCHQUERY_H
+#define GRANKY_LIB_BATCHQUERY_H
+
+#include <cstdint> // uint64_t
+#include <vector>
+
+#include "Query.h"
+
+namespace granky {
+
+/**
+ * Multi-source breadth first search (MS-BFS).
+ *
+ * Runs one BFS per registered source, following egresses, but shares every
+ * edge scan between up to LANES concurrent searches: each node carries a
+ * bitset of the searches that have seen it and of the searches for which
+ * it is on the frontier. More than LANES sources are processed in
+ * consecutive batches.
+ *
+ * Results:
+ * * yieldNode: the number of sources.
+ * * yieldWeight: the sum of all hop distances found.
+ * * yieldDistance: the hop distance from a source to a node, or -1 if unreachable.
+ * * yieldCloseness: the closeness centrality of a source, (reached - 1) / sum of distances.
+ *
+ * A QueryCache tag must tell apart both the sources and whether distances are kept.
+ */
+class MultiSourceBFS : public Query {
+
+public:
+    static constexpr const size_t LANES = 256;
+
+    void addSource(const Graph::Node s);
+    void clearSources();
+
+    /**
+     * When false, only closeness scores are kept, and yieldDistance is unavailable.
+     * The distance matrix costs one Node per source per node.
+     */
+    void keepDistances(const bool keep);
+
+    virtual void init(Graph* graph) override;
+    virtual void execute() override;
+
+    Graph::Node yieldDistance(const size_t index, const Graph::Node node) const;
+    Graph::Weight yieldCloseness(const size_t index) const;
+
+    virtual std::shared_ptr<const Extra> saveExtra() const override;
+    virtual void restoreExtra(const Extra& extra) override;
+
+private:
+    struct Results : Extra {
+
+        std::vector<Graph::Node> distances;
+        std::vector<Graph::Weight> closeness;
+    };
+
+    std::vector<Graph::Node> sources;
+    std::vector<Graph::Node> distances;
+    std::vector<Graph::Weight> closeness;
+    bool keep = true;
+
+    template<size_t WORDS> void run(const size_t first, const size_t count);
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_BATCHQUERY_H
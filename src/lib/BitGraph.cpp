@@ -0,0 +1,333 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cstring> // memcpy, memset
+
+#include <algorithm> // max
+#include <new> // align_val_t
+#include <vector>
+
+#include "BitGraph.h"
+#include "Trace.h"
+
+namespace granky {
+
+static constexpr const size_t ALIGNMENT = BitGraph::ROW_BITS / 8;
+
+void BitGraph::Release::operator()(uint64_t* words) const {
+
+    ::operator delete[](words, std::align_val_t(ALIGNMENT));
+}
+
+BitGraph::Words BitGraph::allocate(const size_t count) {
+
+    const auto bytes = std::max<size_t>(count, 1) * sizeof(uint64_t);
+    auto ret = Words(static_cast<uint64_t*>(::operator new[](bytes, std::align_val_t(ALIGNMENT))));
+    memset(ret.get(), 0, bytes);
+    return ret;
+}
+
+Graph::Node BitGraph::scan(const uint64_t* words, const Node stride, const Node skip, const ProgressCall& callback) {
+
+    Node ret = -1;
+
+    for(Node i = 0; i < stride; ++i) {
+
+        for(auto word = words[i]; word; word &= word - 1) {
+
+            const auto node = static_cast<Node>(i * 64 + __builtin_ctzll(word));
+
+            if(node == skip) {
+
+                continue;
+            }
+
+            if(ret = callback(node, DEFAULT_DEFAULT_WEIGHT); isNode(ret)) {
+
+                return ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node BitGraph::countBoth(const uint64_t* a, const uint64_t* b, const Node stride) {
+
+    Node ret = 0;
+
+    for(Node i = 0; i < stride; ++i) {
+
+        ret += __builtin_popcountll(a[i] & b[i]);
+    }
+
+    return ret;
+}
+
+void BitGraph::grow(const Node node) {
+
+    GRANKY_TRACE("BitGraph::grow");
+
+    // doubling keeps the cost of copying every row amortised
+    const Node wanted = std::max<Node>(node + 1, capacity * 2);
+    const Node newCapacity = (wanted + ROW_BITS - 1) / ROW_BITS * ROW_BITS;
+    const Node newStride = newCapacity / 64;
+    auto newRows = allocate(static_cast<size_t>(newCapacity) * newStride);
+    auto newColumns = allocate(static_cast<size_t>(newCapacity) * newStride);
+    auto newPresent = allocate(newStride);
+
+    for(Node i = 0; i < endNode; ++i) {
+
+        memcpy(newRows.get() + static_cast<size_t>(i) * newStride, getRow(i), stride * sizeof(uint64_t));
+        memcpy(newColumns.get() + static_cast<size_t>(i) * newStride, getColumn(i), stride * sizeof(uint64_t));
+    }
+
+    if(stride) {
+
+        memcpy(newPresent.get(), present.get(), stride * sizeof(uint64_t));
+    }
+
+    rows = std::move(newRows);
+    columns = std::move(newColumns);
+    present = std::move(newPresent);
+    capacity = newCapacity;
+    stride = newStride;
+}
+
+Graph::EdgeList BitGraph::getEdges() const {
+
+    EdgeList ret;
+    ret.reserve(getEdgeCount());
+
+    for(Node from = 0; from < endNode; ++from) {
+
+        const ProgressCall egressCall = [&ret, from](Node to, Weight weight) {
+
+            ret.push_back({from, to, weight});
+            return -1;
+        };
+
+        scan(getRow(from), stride, from, egressCall);
+    }
+
+    return ret;
+}
+
+bool BitGraph::haveNode(const Node node) const {
+
+    return isNode(node) && node < endNode && getBit(present.get(), node);
+}
+
+Graph::Weight BitGraph::getWeight(const Node from, const Node to) const {
+
+    if(from != to && haveNode(from) && haveNode(to) && getBit(getRow(from), to)) {
+
+        return DEFAULT_DEFAULT_WEIGHT;
+    }
+
+    return NO_WEIGHT;
+}
+
+void BitGraph::addNode(const Node node) {
+
+    assert(isNode(node));
+
+    if(node >= capacity) {
+
+        grow(node);
+    }
+
+    if(!getBit(present.get(), node)) {
+
+        present[node / 64] |= uint64_t(1) << (node % 64);
+        endNode = std::max(endNode, node + 1);
+        ++nodeCount;
+        noteNode(node);
+    }
+}
+
+void BitGraph::addEdge(const Node from, const Node to, const Weight weight) {
+
+    assert(isWeight(weight));
+
+    addNode(from);
+    addNode(to);
+
+    const auto previous = getWeight(from, to);
+
+    if(from != to) {
+
+        rows[static_cast<size_t>(from) * stride + to / 64] |= uint64_t(1) << (to % 64);
+        columns[static_cast<size_t>(to) * stride + from / 64] |= uint64_t(1) << (from % 64);
+    }
+
+    noteEdge(from, to, previous, DEFAULT_DEFAULT_WEIGHT);
+}
+
+Graph::Node BitGraph::getNodeCount() const {
+
+    return nodeCount;
+}
+
+Graph::Node BitGraph::getEndNode() const {
+
+    return endNode;
+}
+
+Graph::Node BitGraph::forEachNode(const NodeCall& callback) const {
+
+    Node ret = -1;
+
+    for(Node i = 0; i < stride; ++i) {
+
+        for(auto word = present[i]; word; word &= word - 1) {
+
+            if(ret = callback(static_cast<Node>(i * 64 + __builtin_ctzll(word))); isNode(ret)) {
+
+                return ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node BitGraph::forEachEgress(const Node from, const ProgressCall& callback) const {
+
+    return haveNode(from) ? scan(getRow(from), stride, from, callback) : -1;
+}
+
+Graph::Node BitGraph::forEachIngress(const Node to, const ProgressCall& callback) const {
+
+    return haveNode(to) ? scan(getColumn(to), stride, to, callback) : -1;
+}
+
+Graph::Node BitGraph::forEachLightDigress(const Node from, const ProgressCall& callback) const {
+
+    if(!haveNode(from)) {
+
+        return -1;
+    }
+
+    Node ret = -1;
+    const auto row = getRow(from);
+    const auto column = getColumn(from);
+
+    // every edge weighs the same, so the lighter of two edges is either
+    for(Node i = 0; i < stride; ++i) {
+
+        for(auto word = row[i] | column[i]; word; word &= word - 1) {
+
+            if(ret = callback(static_cast<Node>(i * 64 + __builtin_ctzll(word)), DEFAULT_DEFAULT_WEIGHT); isNode(ret)) {
+
+                return ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node BitGraph::countCommonEgresses(const Node a, const Node b) const {
+
+    return haveNode(a) && haveNode(b) ? countBoth(getRow(a), getRow(b), stride) : 0;
+}
+
+Graph::Node BitGraph::countCommonIngresses(const Node a, const Node b) const {
+
+    return haveNode(a) && haveNode(b) ? countBoth(getColumn(a), getColumn(b), stride) : 0;
+}
+
+Graph::Node BitGraph::countCommonDigresses(const Node a, const Node b) const {
+
+    if(!haveNode(a) || !haveNode(b)) {
+
+        return 0;
+    }
+
+    const auto rowA = getRow(a);
+    const auto rowB = getRow(b);
+    const auto columnA = getColumn(a);
+    const auto columnB = getColumn(b);
+    Node ret = 0;
+
+    for(Node i = 0; i < stride; ++i) {
+
+        ret += __builtin_popcountll((rowA[i] | columnA[i]) & (rowB[i] | columnB[i]));
+    }
+
+    return ret;
+}
+
+uint64_t BitGraph::countTriangles() const {
+
+    GRANKY_TRACE("BitGraph::countTriangles");
+
+    // each triangle u < v < w is counted once, at its lowest edge, among the nodes above v
+    std::vector<uint64_t> neighbours(static_cast<size_t>(endNode) * stride);
+
+    for(Node node = 0; node < endNode; ++node) {
+
+        const auto row = getRow(node);
+        const auto column = getColumn(node);
+        auto out = neighbours.data() + static_cast<size_t>(node) * stride;
+
+        for(Node i = 0; i < stride; ++i) {
+
+            out[i] = row[i] | column[i];
+        }
+    }
+
+    uint64_t ret = 0;
+
+    for(Node u = 0; u < endNode; ++u) {
+
+        const auto around = neighbours.data() + static_cast<size_t>(u) * stride;
+
+        for(Node v = u + 1; v < endNode; ++v) {
+
+            if(!getBit(around, v)) {
+
+                continue;
+            }
+
+            const auto beside = neighbours.data() + static_cast<size_t>(v) * stride;
+            const Node first = (v + 1) / 64;
+
+            // the nodes above v in the word holding v
+            if(first < stride) {
+
+                const auto above = (v + 1) % 64 ? ~uint64_t(0) << ((v + 1) % 64) : ~uint64_t(0);
+                ret += __builtin_popcountll(around[first] & beside[first] & above);
+            }
+
+            for(Node i = first + 1; i < stride; ++i) {
+
+                ret += __builtin_popcountll(around[i] & beside[i]);
+            }
+        }
+    }
+
+    return ret;
+}
+
+} // namespace granky
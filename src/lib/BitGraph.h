@@ -0,0 +1,122 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_BITGRAPH_H
+#define GRANKY_LIB_BITGRAPH_H
+
+#include <cstdint> // uint64_t
+#include <memory> // unique_ptr
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * An adjacency matrix of one bit per cell, for dense unweighted graphs.
+ *
+ * Every edge weighs DEFAULT_DEFAULT_WEIGHT, whatever weight it was added with.
+ * Rows are padded to ROW_BITS, so that whole rows can be combined a vector
+ * register at a time, and a transposed copy is kept so that ingresses scan as
+ * quickly as egresses. Neighbours are found by counting trailing zeros, and
+ * the count methods AND rows together and count the bits left.
+ *
+ * Like MatrixGraph, self loops are not kept, and node presence is a bit apart.
+ */
+class BitGraph : public Graph {
+
+public:
+    static constexpr const Node ROW_BITS = 256;
+
+    BitGraph(const BitGraph&) = delete;
+    BitGraph& operator=(const BitGraph&) = delete;
+    explicit BitGraph() {};
+
+    virtual EdgeList getEdges() const override;
+    virtual bool haveNode(const Node node) const override;
+    virtual Weight getWeight(const Node from, const Node to) const override;
+    virtual void addNode(const Node node) override;
+    virtual void addEdge(const Node from, const Node to, const Weight weight) override;
+    virtual Node getNodeCount() const override;
+    virtual Node getEndNode() const override;
+
+    virtual Node forEachNode(const NodeCall& callback) const override;
+    virtual Node forEachEgress(const Node from, const ProgressCall& callback) const override;
+    virtual Node forEachIngress(const Node to, const ProgressCall& callback) const override;
+    virtual Node forEachLightDigress(const Node from, const ProgressCall& callback) const override;
+
+    /**
+     * The number of nodes both a and b have an egress to, or an ingress from.
+     */
+    Node countCommonEgresses(const Node a, const Node b) const;
+    Node countCommonIngresses(const Node a, const Node b) const;
+
+    /**
+     * The number of nodes joined to both a and b in either direction.
+     */
+    Node countCommonDigresses(const Node a, const Node b) const;
+
+    /**
+     * The number of triangles in the graph, with edges taken in either direction.
+     */
+    uint64_t countTriangles() const;
+
+private:
+    struct Release {
+
+        void operator()(uint64_t* words) const;
+    };
+
+    typedef std::unique_ptr<uint64_t[], Release> Words;
+
+    // row-major egresses, and their transpose, capacity rows of stride words each
+    Words rows;
+    Words columns;
+    Words present;
+    Node capacity = 0;
+    Node stride = 0;
+    Node endNode = 0;
+    Node nodeCount = 0;
+
+    void grow(const Node node);
+
+    inline const uint64_t* getRow(const Node node) const {
+
+        return rows.get() + static_cast<size_t>(node) * stride;
+    }
+
+    inline const uint64_t* getColumn(const Node node) const {
+
+        return columns.get() + static_cast<size_t>(node) * stride;
+    }
+
+    inline bool getBit(const uint64_t* words, const Node bit) const {
+
+        return (words[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    static Words allocate(const size_t count);
+    static Node scan(const uint64_t* words, const Node stride, const Node skip, const ProgressCall& callback);
+    static Node countBoth(const uint64_t* a, const uint64_t* b, const Node stride);
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_BITGRAPH_H
@@ -0,0 +1,614 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <fcntl.h> // fcntl
+#include <poll.h> // poll
+#include <sys/socket.h> // socketpair, send, recv
+#include <sys/wait.h> // waitpid
+#include <unistd.h> // fork, pipe, close, _exit
+
+#include <algorithm> // max
+#include <cstring> // memcpy
+#include <fstream>
+#include <iostream> // cout, cerr
+#include <limits> // numeric_limits
+#include <string>
+
+#include "Cluster.h"
+#include "HashGraph.h"
+#include "Partition.h"
+#include "Trace.h"
+
+namespace granky {
+
+namespace {
+
+/**
+ * Loads the partition and this worker's shard, returning false if either is missing or does not fit.
+ */
+bool loadShard(const std::string& prefix, const Graph::Node rank, const Graph::Node size, Partition& partition, Graph& graph) {
+
+    std::ifstream file(Partition::getShardFile(prefix, rank));
+
+    if(!partition.read(prefix) || partition.getShardCount() != size || !file) {
+
+        return false;
+    }
+
+    file >> graph;
+    return true;
+}
+
+} // namespace
+
+Graph::Node Cluster::Worker::getRank() const {
+
+    return rank;
+}
+
+Graph::Node Cluster::Worker::getSize() const {
+
+    return static_cast<Graph::Node>(sockets.size());
+}
+
+const Cluster::Summary& Cluster::Worker::getTraffic() const {
+
+    return traffic;
+}
+
+uint64_t Cluster::Worker::exchange(const std::vector<std::vector<Graph::Node>>& outgoing,
+        std::vector<Graph::Node>& incoming, const uint64_t active) {
+
+    GRANKY_TRACE("Cluster::Worker::exchange");
+
+    // every message is a header of the sender's active and the node count, then the nodes
+    struct Peer {
+
+        std::vector<char> out;
+        size_t sent = 0;
+        uint64_t header[2] = {0, 0};
+        std::vector<Graph::Node> in;
+        size_t received = 0;
+
+        size_t getExpected() const {
+
+            return sizeof(header) + (received >= sizeof(header) ? header[1] * sizeof(Graph::Node) : 0);
+        }
+    };
+
+    const auto size = getSize();
+    std::vector<Peer> peers(size);
+    std::vector<pollfd> polls;
+    std::vector<Graph::Node> polled;
+    size_t pending = 0;
+
+    for(Graph::Node peer = 0; peer < size; ++peer) {
+
+        if(peer == rank) {
+
+            continue;
+        }
+
+        const auto count = static_cast<size_t>(peer) < outgoing.size() ? outgoing[peer].size() : 0;
+        const uint64_t header[2] = {active, count};
+        auto& out = peers[peer].out;
+        out.resize(sizeof(header) + count * sizeof(Graph::Node));
+        memcpy(out.data(), header, sizeof(header));
+
+        if(count) {
+
+            memcpy(out.data() + sizeof(header), outgoing[peer].data(), count * sizeof(Graph::Node));
+        }
+
+        ++traffic.messages;
+        traffic.bytes += out.size();
+        pending += 2;
+    }
+
+    const auto fail = []() {
+
+        std::cerr << "Cluster: lost a peer" << std::endl;
+        _exit(1);
+    };
+
+    // sending and receiving together, so that no two workers wait on one another's full buffers
+    while(pending) {
+
+        polls.clear();
+        polled.clear();
+
+        for(Graph::Node peer = 0; peer < size; ++peer) {
+
+            const auto& each = peers[peer];
+            short events = 0;
+
+            if(peer != rank && each.sent < each.out.size()) {
+
+                events |= POLLOUT;
+            }
+
+            if(peer != rank && each.received < each.getExpected()) {
+
+                events |= POLLIN;
+            }
+
+            if(events) {
+
+                polls.push_back({sockets[peer], events, 0});
+                polled.push_back(peer);
+            }
+        }
+
+        if(poll(polls.data(), polls.size(), -1) < 0) {
+
+            if(errno == EINTR) {
+
+                continue;
+            }
+
+            fail();
+        }
+
+        for(size_t i = 0; i < polls.size(); ++i) {
+
+            auto& each = peers[polled[i]];
+            const auto socket = polls[i].fd;
+
+            if(polls[i].revents & POLLOUT) {
+
+                const auto sent = send(socket, each.out.data() + each.sent, each.out.size() - each.sent, MSG_NOSIGNAL);
+
+                if(sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+
+                    fail();
+                }
+
+                each.sent += sent > 0 ? sent : 0;
+                pending -= each.sent == each.out.size();
+            }
+
+            if(polls[i].revents & (POLLIN | POLLHUP | POLLERR) && each.received < each.getExpected()) {
+
+                const bool inHeader = each.received < sizeof(each.header);
+                auto target = inHeader ? reinterpret_cast<char*>(each.header) + each.received :
+                        reinterpret_cast<char*>(each.in.data()) + (each.received - sizeof(each.header));
+                const auto wanted = inHeader ? sizeof(each.header) - each.received : each.getExpected() - each.received;
+                const auto received = recv(socket, target, wanted, 0);
+
+                if(received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+
+                    fail();
+                }
+
+                each.received += received > 0 ? received : 0;
+
+                if(inHeader && each.received == sizeof(each.header)) {
+
+                    each.in.resize(each.header[1]);
+                }
+
+                pending -= each.received == each.getExpected();
+            }
+        }
+    }
+
+    uint64_t ret = active;
+    incoming.clear();
+
+    for(const auto& each : peers) {
+
+        ret += each.header[0];
+        incoming.insert(incoming.end(), each.in.begin(), each.in.end());
+    }
+
+    ++traffic.rounds;
+    return ret;
+}
+
+Cluster::Cluster(const Graph::Node workers) : workers(workers) {
+
+}
+
+bool Cluster::run(const Work& work, std::vector<Summary>& summaries) const {
+
+    GRANKY_TRACE("Cluster::run");
+
+    summaries.assign(workers, Summary());
+
+    // socket [a][b] is worker a's end of the pair joining it to worker b
+    std::vector<std::vector<int>> mesh(workers, std::vector<int>(workers, -1));
+    std::vector<int> results;
+    std::vector<pid_t> children;
+    bool ret = true;
+
+    const auto closeMesh = [&mesh](const Graph::Node keep) {
+
+        for(Graph::Node a = 0; a < static_cast<Graph::Node>(mesh.size()); ++a) {
+
+            for(auto& socket : mesh[a]) {
+
+                if(a != keep && socket >= 0) {
+
+                    close(socket);
+                    socket = -1;
+                }
+            }
+        }
+    };
+
+    for(Graph::Node a = 0; a < workers && ret; ++a) {
+
+        for(Graph::Node b = a + 1; b < workers && ret; ++b) {
+
+            int pair[2];
+            ret = socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0;
+            mesh[a][b] = ret ? pair[0] : -1;
+            mesh[b][a] = ret ? pair[1] : -1;
+        }
+    }
+
+    // nothing buffered before the fork may be written twice
+    std::cout.flush();
+    std::cerr.flush();
+
+    for(Graph::Node rank = 0; rank < workers && ret; ++rank) {
+
+        int result[2];
+
+        if(pipe(result) != 0) {
+
+            ret = false;
+            break;
+        }
+
+        const auto child = fork();
+
+        if(child == 0) {
+
+            close(result[0]);
+            closeMesh(rank);
+
+            for(const auto each : results) {
+
+                close(each);
+            }
+
+            Worker worker;
+            worker.rank = rank;
+            worker.sockets = mesh[rank];
+
+            for(const auto socket : worker.sockets) {
+
+                if(socket >= 0) {
+
+                    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+                }
+            }
+
+            Summary summary;
+            const bool done = work(worker, summary);
+            summary.rounds = worker.traffic.rounds;
+            summary.messages = worker.traffic.messages;
+            summary.bytes = worker.traffic.bytes;
+            std::cout.flush();
+
+            // a summary is smaller than a pipe's buffer, so it is written whole
+            const bool written = done && ::write(result[1], &summary, sizeof(summary)) == sizeof(summary);
+            _exit(written ? 0 : 1);
+        }
+
+        close(result[1]);
+
+        if(child < 0) {
+
+            close(result[0]);
+            ret = false;
+            break;
+        }
+
+        results.push_back(result[0]);
+        children.push_back(child);
+    }
+
+    // the parent's ends are closed, so a worker whose peer was never started sees it gone
+    closeMesh(-1);
+
+    for(size_t rank = 0; rank < results.size(); ++rank) {
+
+        size_t received = 0;
+        auto target = reinterpret_cast<char*>(&summaries[rank]);
+
+        while(received < sizeof(Summary)) {
+
+            const auto got = read(results[rank], target + received, sizeof(Summary) - received);
+
+            if(got <= 0 && !(got < 0 && errno == EINTR)) {
+
+                break;
+            }
+
+            received += got > 0 ? got : 0;
+        }
+
+        ret = ret && received == sizeof(Summary);
+        close(results[rank]);
+    }
+
+    for(const auto child : children) {
+
+        int status = 0;
+
+        while(waitpid(child, &status, 0) < 0 && errno == EINTR) {
+
+        }
+
+        ret = ret && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    return ret;
+}
+
+bool Cluster::breadthFirst(std::string_view prefix, const Graph::Node source, std::vector<Summary>& summaries) const {
+
+    const std::string path(prefix);
+
+    return run([&path, source](Worker& worker, Summary& summary) {
+
+        const auto rank = worker.getRank();
+        Partition partition;
+        HashGraph graph;
+
+        if(!loadShard(path, rank, worker.getSize(), partition, graph)) {
+
+            return false;
+        }
+
+        const auto end = graph.getEndNode();
+        std::vector<Graph::Node> distances(end, -1);
+        std::vector<bool> sent(end, false);
+        std::vector<Graph::Node> frontier;
+        std::vector<Graph::Node> next;
+        std::vector<Graph::Node> incoming;
+        std::vector<std::vector<Graph::Node>> outgoing(worker.getSize());
+        Graph::Node depth = 0;
+
+        if(partition.getOwner(source) == rank && graph.haveNode(source)) {
+
+            distances[source] = 0;
+            frontier.push_back(source);
+        }
+
+        // nodes of other shards are sent to their owner once, since the first round to reach one is the nearest
+        const Graph::ProgressCall visit = [&](Graph::Node node, Graph::Weight) {
+
+            const auto owner = partition.getOwner(node);
+
+            if(owner == rank && distances[node] < 0) {
+
+                distances[node] = depth + 1;
+                next.push_back(node);
+            }
+            else if(owner != rank && Graph::isNode(owner) && !sent[node]) {
+
+                sent[node] = true;
+                outgoing[owner].push_back(node);
+            }
+
+            return -1;
+        };
+
+        for(;;) {
+
+            next.clear();
+
+            for(auto& each : outgoing) {
+
+                each.clear();
+            }
+
+            for(const auto node : frontier) {
+
+                graph.forEachEgress(node, visit);
+            }
+
+            uint64_t active = next.size();
+
+            for(const auto& each : outgoing) {
+
+                active += each.size();
+            }
+
+            const auto remaining = worker.exchange(outgoing, incoming, active);
+
+            for(const auto node : incoming) {
+
+                if(Graph::isNode(node) && node < end && distances[node] < 0) {
+
+                    distances[node] = depth + 1;
+                    next.push_back(node);
+                }
+            }
+
+            if(!remaining) {
+
+                break;
+            }
+
+            frontier.swap(next);
+            ++depth;
+        }
+
+        graph.forEachNode([&](Graph::Node node) -> Graph::Node {
+
+            if(partition.getOwner(node) == rank && distances[node] >= 0) {
+
+                ++summary.count;
+                summary.total += distances[node];
+                summary.depth = std::max<uint64_t>(summary.depth, distances[node]);
+            }
+
+            return -1;
+        });
+
+        return true;
+    }, summaries);
+}
+
+bool Cluster::colorComponents(std::string_view prefix, std::vector<Summary>& summaries) const {
+
+    const std::string path(prefix);
+
+    return run([&path](Worker& worker, Summary& summary) {
+
+        const auto rank = worker.getRank();
+        Partition partition;
+        HashGraph graph;
+
+        if(!loadShard(path, rank, worker.getSize(), partition, graph)) {
+
+            return false;
+        }
+
+        const auto end = graph.getEndNode();
+        std::vector<Graph::Node> labels(end, -1);
+        std::vector<Graph::Node> sentLabels(end, std::numeric_limits<Graph::Node>::max());
+        std::vector<uint64_t> changedAt(end, 0);
+        std::vector<Graph::Node> changed;
+        std::vector<Graph::Node> next;
+        std::vector<Graph::Node> incoming;
+        std::vector<std::vector<Graph::Node>> outgoing(worker.getSize());
+        uint64_t round = 1;
+        Graph::Node label = -1;
+
+        graph.forEachNode([&](Graph::Node node) -> Graph::Node {
+
+            if(partition.getOwner(node) == rank) {
+
+                labels[node] = node;
+                changed.push_back(node);
+                ++summary.total;
+            }
+
+            return -1;
+        });
+
+        const auto lower = [&](const Graph::Node node, const Graph::Node to) {
+
+            if(to < labels[node]) {
+
+                labels[node] = to;
+
+                if(changedAt[node] != round) {
+
+                    changedAt[node] = round;
+                    next.push_back(node);
+                }
+            }
+        };
+
+        // labels only fall, so a label no lower than one already sent need not be sent again
+        const Graph::ProgressCall spread = [&](Graph::Node node, Graph::Weight) {
+
+            const auto owner = partition.getOwner(node);
+
+            if(owner == rank) {
+
+                lower(node, label);
+            }
+            else if(Graph::isNode(owner) && label < sentLabels[node]) {
+
+                sentLabels[node] = label;
+                outgoing[owner].push_back(node);
+                outgoing[owner].push_back(label);
+            }
+
+            return -1;
+        };
+
+        for(;; ++round) {
+
+            next.clear();
+
+            for(auto& each : outgoing) {
+
+                each.clear();
+            }
+
+            for(const auto node : changed) {
+
+                label = labels[node];
+                graph.forEachEgress(node, spread);
+                graph.forEachIngress(node, spread);
+            }
+
+            uint64_t active = next.size();
+
+            for(const auto& each : outgoing) {
+
+                active += each.size();
+            }
+
+            const auto remaining = worker.exchange(outgoing, incoming, active);
+
+            for(size_t i = 0; i + 1 < incoming.size(); i += 2) {
+
+                if(Graph::isNode(incoming[i]) && incoming[i] < end && partition.getOwner(incoming[i]) == rank) {
+
+                    lower(incoming[i], incoming[i + 1]);
+                }
+            }
+
+            if(!remaining) {
+
+                break;
+            }
+
+            changed.swap(next);
+        }
+
+        for(Graph::Node node = 0; node < end; ++node) {
+
+            summary.count += partition.getOwner(node) == rank && labels[node] == node;
+        }
+
+        return true;
+    }, summaries);
+}
+
+Cluster::Summary Cluster::combine(const std::vector<Summary>& summaries) {
+
+    Summary ret;
+
+    for(const auto& each : summaries) {
+
+        ret.count += each.count;
+        ret.total += each.total;
+        ret.depth = std::max(ret.depth, each.depth);
+        ret.rounds = std::max(ret.rounds, each.rounds);
+        ret.messages += each.messages;
+        ret.bytes += each.bytes;
+    }
+
+    return ret;
+}
+
+} // namespace granky
@@ -0,0 +1,130 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_CLUSTER_H
+#define GRANKY_LIB_CLUSTER_H
+
+#include <cstdint> // uint64_t
+#include <functional> // function
+#include <string_view>
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * Runs a search over a partitioned graph in several local processes, one per
+ * shard, each holding only its own shard as written by Partition::write.
+ *
+ * The processes are forked together and joined pairwise by Unix domain
+ * sockets. They work in bulk synchronous rounds: in every round each worker
+ * expands its own part of the search, then exchanges one batch of nodes with
+ * every other worker, carrying the nodes the batch's receiver owns. Along with
+ * its batch, each worker sends how much work it has left, so that all of them
+ * see the same total and stop in the same round.
+ *
+ * The summaries of every worker, including the traffic it sent, are gathered
+ * back in the calling process.
+ */
+class Cluster {
+
+public:
+    /**
+     * What one worker found and sent. For breadthFirst, count is the number of
+     * its nodes reached, total their summed hop distances and depth the
+     * greatest. For colorComponents, count is the number of components whose
+     * lowest node is one of its own, and total the number of nodes it owns.
+     */
+    struct Summary {
+
+        uint64_t count = 0;
+        uint64_t total = 0;
+        uint64_t depth = 0;
+        uint64_t rounds = 0;
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+    };
+
+    /**
+     * One process's end of the cluster.
+     */
+    class Worker {
+
+    public:
+        Graph::Node getRank() const;
+        Graph::Node getSize() const;
+
+        /**
+         * Sends outgoing[peer] to every other worker, and replaces incoming
+         * with everything received. Returns the sum of every worker's active.
+         * Every worker must call exchange the same number of times; a worker
+         * whose peer has gone exits at once.
+         */
+        uint64_t exchange(const std::vector<std::vector<Graph::Node>>& outgoing,
+                std::vector<Graph::Node>& incoming, const uint64_t active);
+
+        const Summary& getTraffic() const;
+
+    private:
+        friend class Cluster;
+
+        Graph::Node rank = 0;
+        std::vector<int> sockets;
+        Summary traffic;
+    };
+
+    /**
+     * Runs in each worker's process, filling in its summary, and returns false on failure.
+     */
+    typedef std::function<bool(Worker&, Summary&)> Work;
+
+    explicit Cluster(const Graph::Node workers);
+
+    /**
+     * Forks a process per worker, runs work in each, and gathers every summary.
+     * Returns false if a worker could not be started or failed.
+     */
+    bool run(const Work& work, std::vector<Summary>& summaries) const;
+
+    /**
+     * Hop distances from source along egresses, over the shards at prefix.
+     */
+    bool breadthFirst(std::string_view prefix, const Graph::Node source, std::vector<Summary>& summaries) const;
+
+    /**
+     * Connected components, following edges in both directions, by passing the
+     * lowest node seen between neighbours until no label changes.
+     */
+    bool colorComponents(std::string_view prefix, std::vector<Summary>& summaries) const;
+
+    /**
+     * The summaries of every worker added together, but for depth and rounds, which are the greatest.
+     */
+    static Summary combine(const std::vector<Summary>& summaries);
+
+private:
+    const Graph::Node workers;
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_CLUSTER_H
@@ -0,0 +1,180 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+
+#include <utility> // swap
+
+#include "ComponentTracker.h"
+
+namespace granky {
+
+ComponentTracker::~ComponentTracker() {
+
+    if(graph) {
+
+        graph->detach(this);
+    }
+}
+
+void ComponentTracker::init(Graph* g) {
+
+    GRANKY_PHASE("init");
+    assert(g);
+
+    if(graph) {
+
+        graph->detach(this);
+    }
+
+    graph = g;
+    parent.clear();
+    size.clear();
+    components = 0;
+
+    const Graph::NodeCall nodeCall = [this](Graph::Node node) {
+
+        GRANKY_STAT(callbacks, 1);
+        onNode(node);
+        return -1;
+    };
+
+    const Graph::EdgeCall edgeCall = [this](Graph::Node from, Graph::Node to, Graph::Weight) {
+
+        GRANKY_STAT(examined, 1);
+        GRANKY_STAT(callbacks, 1);
+        join(from, to);
+        return -1;
+    };
+
+    graph->forEachNode(nodeCall);
+    graph->forEachEdge(edgeCall);
+    graph->attach(this);
+}
+
+void ComponentTracker::execute() {
+
+    GRANKY_PHASE("execute");
+    GRANKY_TRACE("ComponentTracker::execute");
+    cachedTable.reset();
+    assert(graph);
+
+    table = graph->getBlankNodeTally();
+    GRANKY_STAT(allocations, 1);
+    std::vector<Graph::Node> label(parent.size(), -1);
+    Graph::Node counter = 0;
+
+    // ColorComponents labels a component with the count of nodes iterated before its first
+    const Graph::NodeCall nodeCall = [this, &label, &counter](Graph::Node sub) {
+
+        GRANKY_STAT(visited, 1);
+        GRANKY_STAT(callbacks, 1);
+        const auto root = find(sub);
+
+        if(!Graph::isNode(label[root])) {
+
+            label[root] = counter;
+        }
+
+        table->set(sub, label[root]);
+        ++counter;
+        return -1;
+    };
+
+    graph->forEachNode(nodeCall);
+    node = components;
+    weight = Graph::NO_WEIGHT;
+}
+
+void ComponentTracker::onNode(const Graph::Node n) {
+
+    if(static_cast<size_t>(n) >= parent.size()) {
+
+        parent.resize(n + 1, -1);
+        size.resize(n + 1, 0);
+    }
+
+    if(!Graph::isNode(parent[n])) {
+
+        parent[n] = n;
+        size[n] = 1;
+        ++components;
+    }
+}
+
+void ComponentTracker::onEdge(const Graph::Node from, const Graph::Node to, const Graph::Weight, const Graph::Weight) {
+
+    join(from, to);
+}
+
+bool ComponentTracker::isConnected(const Graph::Node a, const Graph::Node b) {
+
+    if(!Graph::isNode(a) || !Graph::isNode(b) || static_cast<size_t>(a) >= parent.size() || static_cast<size_t>(b) >= parent.size()) {
+
+        return false;
+    }
+
+    if(!Graph::isNode(parent[a]) || !Graph::isNode(parent[b])) {
+
+        return false;
+    }
+
+    return find(a) == find(b);
+}
+
+Graph::Node ComponentTracker::getComponentCount() const {
+
+    return components;
+}
+
+Graph::Node ComponentTracker::find(Graph::Node n) {
+
+    // path halving
+    while(parent[n] != n) {
+
+        parent[n] = parent[parent[n]];
+        n = parent[n];
+    }
+
+    return n;
+}
+
+void ComponentTracker::join(const Graph::Node a, const Graph::Node b) {
+
+    auto x = find(a);
+    auto y = find(b);
+
+    if(x == y) {
+
+        return;
+    }
+
+    if(size[x] < size[y]) {
+
+        std::swap(x, y);
+    }
+
+    parent[y] = x;
+    size[x] += size[y];
+    --components;
+}
+
+} // namespace granky
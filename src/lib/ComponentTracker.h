@@ -0,0 +1,74 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_COMPONENTTRACKER_H
+#define GRANKY_LIB_COMPONENTTRACKER_H
+
+#include <vector>
+
+#include "Query.h"
+
+namespace granky {
+
+/**
+ * Keeps the connected components of a graph up to date as it grows.
+ *
+ * init attaches the tracker to a graph as an Observer, and every addNode
+ * and addEdge from then on updates a union-find forest, so isConnected and
+ * getComponentCount are near constant time at any moment. Like
+ * ColorComponents, edges are followed in both directions.
+ *
+ * execute labels every node exactly as a fresh ColorComponents run would,
+ * in one pass over the nodes:
+ * * yieldTable: the label of every node, or -1 for leaves.
+ * * yieldNode: the number of components.
+ *
+ * The graph must outlive the tracker, or the tracker must be reinitialised first.
+ */
+class ComponentTracker : public Query, public Graph::Observer {
+
+public:
+    ComponentTracker() = default;
+    ComponentTracker(const ComponentTracker&) = delete;
+    ComponentTracker& operator=(const ComponentTracker&) = delete;
+    virtual ~ComponentTracker();
+
+    virtual void init(Graph* graph) override;
+    virtual void execute() override;
+
+    virtual void onNode(const Graph::Node node) override;
+    virtual void onEdge(const Graph::Node from, const Graph::Node to, const Graph::Weight previous, const Graph::Weight weight) override;
+
+    bool isConnected(const Graph::Node a, const Graph::Node b);
+    Graph::Node getComponentCount() const;
+
+private:
+    std::vector<Graph::Node> parent;
+    std::vector<Graph::Node> size;
+    Graph::Node components = 0;
+
+    Graph::Node find(Graph::Node node);
+    void join(const Graph::Node a, const Graph::Node b);
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_COMPONENTTRACKER_H
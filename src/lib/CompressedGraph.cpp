@@ -0,0 +1,761 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cstring> // memcmp
+
+#include <algorithm> // sort, unique, lower_bound, min
+#include <array>
+#include <atomic>
+
+// the shuffle is compiled for SSSE3 alone, and chosen at run time where the processor has it
+#if defined(__x86_64__) || defined(__i386__)
+#define GRANKY_SHUFFLE
+#include <tmmintrin.h> // _mm_shuffle_epi8
+#endif
+
+#include "CompressedGraph.h"
+#include "Trace.h"
+
+namespace granky {
+
+namespace {
+
+const char MAGIC[8] = {'G', 'R', 'A', 'N', 'K', 'Y', 'C', '1'};
+
+// a full group is loaded sixteen bytes at a time, so every list is followed by that much
+const size_t SLACK = 16;
+
+/**
+ * For every control byte, the length of its group, and the shuffle that
+ * spreads its bytes over four 32 bit lanes.
+ */
+struct Tables {
+
+    std::array<uint8_t, 256> lengths;
+    std::array<std::array<uint8_t, 16>, 256> shuffles;
+
+    Tables() {
+
+        for(unsigned control = 0; control < 256; ++control) {
+
+            uint8_t at = 0;
+
+            for(unsigned lane = 0; lane < 4; ++lane) {
+
+                const unsigned length = ((control >> (lane * 2)) & 3) + 1;
+
+                for(unsigned i = 0; i < 4; ++i) {
+
+                    // 0x80 zeroes a byte in a shuffle
+                    shuffles[control][lane * 4 + i] = i < length ? at + i : 0x80;
+                }
+
+                at += length;
+            }
+
+            lengths[control] = at;
+        }
+    }
+};
+
+const Tables tables;
+
+inline unsigned writeValue(std::vector<uint8_t>& bytes, const uint32_t value) {
+
+    const unsigned length = value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+
+    for(unsigned i = 0; i < length; ++i) {
+
+        bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+
+    return length - 1;
+}
+
+#ifdef GRANKY_SHUFFLE
+__attribute__((target("ssse3")))
+void shuffleGroup(const uint8_t*& at, const uint8_t control, uint32_t* out) {
+
+    const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(at));
+    const auto shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.shuffles[control].data()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(data, shuffle));
+    at += tables.lengths[control];
+}
+
+bool canShuffle() {
+
+    return __builtin_cpu_supports("ssse3");
+}
+#else
+bool canShuffle() {
+
+    return false;
+}
+#endif
+
+std::atomic<bool> shuffled(canShuffle());
+
+inline void decodeGroup(const uint8_t*& at, const uint8_t control, uint32_t* out, const bool shuffle) {
+
+#ifdef GRANKY_SHUFFLE
+    if(shuffle) {
+
+        shuffleGroup(at, control, out);
+        return;
+    }
+#else
+    (void) shuffle;
+#endif
+
+    for(unsigned lane = 0; lane < 4; ++lane) {
+
+        const unsigned length = ((control >> (lane * 2)) & 3) + 1;
+        uint32_t value = 0;
+
+        for(unsigned i = 0; i < length; ++i) {
+
+            value |= uint32_t(at[i]) << (i * 8);
+        }
+
+        out[lane] = value;
+        at += length;
+    }
+}
+
+/**
+ * The last group of a list may hold fewer than four values, and so fewer bytes than its control suggests.
+ */
+inline void decodePartial(const uint8_t*& at, const uint8_t control, const unsigned count, uint32_t* out) {
+
+    for(unsigned lane = 0; lane < count; ++lane) {
+
+        const unsigned length = ((control >> (lane * 2)) & 3) + 1;
+        uint32_t value = 0;
+
+        for(unsigned i = 0; i < length; ++i) {
+
+            value |= uint32_t(at[i]) << (i * 8);
+        }
+
+        out[lane] = value;
+        at += length;
+    }
+}
+
+/**
+ * The bytes taken by the first count values of a group.
+ */
+inline unsigned measureGroup(const uint8_t control, const unsigned count) {
+
+    unsigned ret = 0;
+
+    for(unsigned lane = 0; lane < count; ++lane) {
+
+        ret += ((control >> (lane * 2)) & 3) + 1;
+    }
+
+    return ret;
+}
+
+template<typename VALUE>
+void writeRaw(std::ostream& out, const VALUE& value) {
+
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename VALUE>
+bool readRaw(std::istream& in, VALUE& value) {
+
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template<typename VALUE>
+void writeVector(std::ostream& out, const std::vector<VALUE>& values) {
+
+    writeRaw(out, static_cast<uint64_t>(values.size()));
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(VALUE));
+}
+
+template<typename VALUE>
+bool readVector(std::istream& in, std::vector<VALUE>& values) {
+
+    uint64_t size = 0;
+
+    if(!readRaw(in, size)) {
+
+        return false;
+    }
+
+    // read in pieces, so that a corrupt size runs out of stream before it runs out of memory
+    const uint64_t piece = (1 << 20) / sizeof(VALUE);
+    values.clear();
+
+    while(values.size() < size) {
+
+        const auto at = values.size();
+        values.resize(at + std::min<uint64_t>(piece, size - at));
+
+        if(!in.read(reinterpret_cast<char*>(values.data() + at), (values.size() - at) * sizeof(VALUE))) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+void CompressedGraph::Lists::clear() {
+
+    offsets.clear();
+    degrees.clear();
+    bytes.clear();
+}
+
+size_t CompressedGraph::Lists::getBytes() const {
+
+    return offsets.size() * sizeof(uint64_t) + degrees.size() * sizeof(uint32_t) + bytes.size();
+}
+
+bool CompressedGraph::isShuffled() {
+
+    return shuffled.load(std::memory_order_relaxed);
+}
+
+void CompressedGraph::setShuffled(const bool shuffle) {
+
+    shuffled.store(shuffle && canShuffle(), std::memory_order_relaxed);
+}
+
+CompressedGraph::CompressedGraph(const Graph& source) {
+
+    build(source);
+}
+
+void CompressedGraph::clear() {
+
+    present.clear();
+    weights.clear();
+    egress.clear();
+    ingress.clear();
+    nodeCount = 0;
+    fingerprint = 0;
+    edgeCount = 0;
+    version = drawVersion();
+}
+
+void CompressedGraph::build(const Graph& source) {
+
+    GRANKY_TRACE("CompressedGraph::build");
+    clear();
+
+    const auto end = source.getEndNode();
+    assert(static_cast<uint64_t>(end) <= UINT32_MAX);
+    present.resize(end, false);
+
+    const NodeCall nodeCall = [this](Node node) {
+
+        present[node] = true;
+        ++nodeCount;
+        return -1;
+    };
+
+    source.forEachNode(nodeCall);
+
+    const EdgeCall edgeCall = [this](Node from, Node to, Weight weight) {
+
+        weights.push_back(weight);
+
+        if(from != to) {
+
+            fingerprint += hashEdge(from, to, weight);
+            ++edgeCount;
+        }
+
+        return -1;
+    };
+
+    source.forEachEdge(edgeCall);
+    std::sort(weights.begin(), weights.end());
+    weights.erase(std::unique(weights.begin(), weights.end()), weights.end());
+
+    std::vector<std::pair<Node, Weight>> list;
+
+    const ProgressCall listCall = [&list](Node node, Weight weight) {
+
+        list.emplace_back(node, weight);
+        return -1;
+    };
+
+    for(Node node = 0; node < end; ++node) {
+
+        list.clear();
+        source.forEachEgress(node, listCall);
+        encode(egress, node, list);
+        list.clear();
+        source.forEachIngress(node, listCall);
+        encode(ingress, node, list);
+    }
+
+    for(auto lists : {&egress, &ingress}) {
+
+        lists->offsets.push_back(lists->bytes.size());
+        lists->bytes.resize(lists->bytes.size() + SLACK, 0);
+        lists->bytes.shrink_to_fit();
+    }
+
+    version = source.getVersion();
+}
+
+void CompressedGraph::encode(Lists& lists, const Node node, std::vector<std::pair<Node, Weight>>& list) const {
+
+    assert(static_cast<Node>(lists.offsets.size()) == node);
+    std::sort(list.begin(), list.end());
+    lists.offsets.push_back(lists.bytes.size());
+    lists.degrees.push_back(static_cast<uint32_t>(list.size()));
+
+    auto& bytes = lists.bytes;
+    Node previous = 0;
+
+    for(size_t group = 0; group < list.size(); group += 4) {
+
+        const auto count = std::min<size_t>(4, list.size() - group);
+        const auto control = bytes.size();
+        uint8_t nodes = 0;
+        uint8_t indices = 0;
+
+        bytes.push_back(0);
+
+        if(isWeighted()) {
+
+            bytes.push_back(0);
+        }
+
+        for(size_t lane = 0; lane < count; ++lane) {
+
+            const auto next = list[group + lane].first;
+            nodes |= writeValue(bytes, static_cast<uint32_t>(next - previous)) << (lane * 2);
+            previous = next;
+        }
+
+        if(isWeighted()) {
+
+            for(size_t lane = 0; lane < count; ++lane) {
+
+                const auto index = std::lower_bound(weights.begin(), weights.end(), list[group + lane].second) - weights.begin();
+                indices |= writeValue(bytes, static_cast<uint32_t>(index)) << (lane * 2);
+            }
+
+            bytes[control + 1] = indices;
+        }
+
+        bytes[control] = nodes;
+    }
+}
+
+template<class CALL>
+Graph::Node CompressedGraph::decode(const Lists& lists, const Node node, CALL&& call) const {
+
+    if(!haveNode(node)) {
+
+        return -1;
+    }
+
+    const auto weighted = isWeighted();
+    const auto shuffle = shuffled.load(std::memory_order_relaxed);
+    const auto single = weights.empty() ? DEFAULT_DEFAULT_WEIGHT : weights[0];
+    const auto degree = lists.degrees[node];
+    const uint8_t* at = lists.bytes.data() + lists.offsets[node];
+    uint32_t nodes[4];
+    uint32_t indices[4] = {0, 0, 0, 0};
+    Node previous = 0;
+    Node ret = -1;
+
+    for(uint32_t group = 0; group < degree; group += 4) {
+
+        const auto count = std::min<uint32_t>(4, degree - group);
+        const auto nodeControl = *at++;
+        const auto indexControl = weighted ? *at++ : 0;
+
+        if(count == 4) {
+
+            decodeGroup(at, nodeControl, nodes, shuffle);
+
+            if(weighted) {
+
+                decodeGroup(at, indexControl, indices, shuffle);
+            }
+        }
+        else {
+
+            decodePartial(at, nodeControl, count, nodes);
+
+            if(weighted) {
+
+                decodePartial(at, indexControl, count, indices);
+            }
+        }
+
+        for(uint32_t lane = 0; lane < count; ++lane) {
+
+            previous += static_cast<Node>(nodes[lane]);
+
+            if(ret = call(previous, weighted ? weights[indices[lane]] : single); isNode(ret)) {
+
+                return ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+void CompressedGraph::save(std::ostream& out) const {
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writeRaw(out, static_cast<uint32_t>(sizeof(Node)));
+    writeRaw(out, static_cast<uint32_t>(sizeof(Weight)));
+    writeRaw(out, static_cast<uint64_t>(nodeCount));
+    writeRaw(out, static_cast<uint64_t>(edgeCount));
+    writeRaw(out, fingerprint);
+
+    std::vector<uint8_t> bits((present.size() + 7) / 8, 0);
+
+    for(size_t i = 0; i < present.size(); ++i) {
+
+        bits[i / 8] |= present[i] << (i % 8);
+    }
+
+    writeRaw(out, static_cast<uint64_t>(present.size()));
+    writeVector(out, bits);
+    writeVector(out, weights);
+
+    for(auto lists : {&egress, &ingress}) {
+
+        writeVector(out, lists->offsets);
+        writeVector(out, lists->degrees);
+        writeVector(out, lists->bytes);
+    }
+}
+
+bool CompressedGraph::load(std::istream& in) {
+
+    GRANKY_TRACE("CompressedGraph::load");
+    clear();
+
+    char magic[sizeof(MAGIC)];
+    uint32_t nodeSize = 0;
+    uint32_t weightSize = 0;
+    uint64_t nodes = 0;
+    uint64_t edges = 0;
+    uint64_t end = 0;
+    std::vector<uint8_t> bits;
+
+    bool ok = in.read(magic, sizeof(magic)) && !memcmp(magic, MAGIC, sizeof(MAGIC))
+        && readRaw(in, nodeSize) && nodeSize == sizeof(Node)
+        && readRaw(in, weightSize) && weightSize == sizeof(Weight)
+        && readRaw(in, nodes) && readRaw(in, edges) && readRaw(in, fingerprint)
+        && readRaw(in, end) && end <= UINT32_MAX && readVector(in, bits) && bits.size() == (end + 7) / 8
+        && readVector(in, weights);
+
+    for(auto lists : {&egress, &ingress}) {
+
+        ok = ok && readVector(in, lists->offsets) && readVector(in, lists->degrees) && readVector(in, lists->bytes)
+            && lists->offsets.size() == end + 1 && lists->degrees.size() == end
+            && lists->bytes.size() >= SLACK && lists->offsets.back() == lists->bytes.size() - SLACK;
+
+        for(uint64_t i = 0; ok && i < end; ++i) {
+
+            ok = lists->offsets[i] <= lists->offsets[i + 1];
+        }
+    }
+
+    if(ok) {
+
+        present.resize(end);
+
+        for(uint64_t i = 0; i < end; ++i) {
+
+            present[i] = (bits[i / 8] >> (i % 8)) & 1;
+        }
+
+        // the counts and fingerprint in the header must be those of the lists, in both directions
+        size_t egressEdges = 0;
+        size_t ingressEdges = 0;
+        uint64_t egressHash = 0;
+        uint64_t ingressHash = 0;
+        uint64_t count = 0;
+
+        for(uint64_t i = 0; i < end; ++i) {
+
+            count += present[i];
+        }
+
+        ok = check(egress, true, egressEdges, egressHash) && check(ingress, false, ingressEdges, ingressHash)
+            && egressEdges == edges && ingressEdges == edges && egressHash == fingerprint && ingressHash == fingerprint
+            && count == nodes;
+    }
+
+    if(!ok) {
+
+        clear();
+        return false;
+    }
+
+    nodeCount = static_cast<Node>(nodes);
+    edgeCount = edges;
+    return true;
+}
+
+bool CompressedGraph::check(const Lists& lists, const bool forward, size_t& edges, uint64_t& hash) const {
+
+    const auto weighted = isWeighted();
+    uint32_t nodes[4];
+    uint32_t indices[4] = {0, 0, 0, 0};
+
+    for(uint64_t node = 0; node < present.size(); ++node) {
+
+        const auto degree = lists.degrees[node];
+        const uint8_t* at = lists.bytes.data() + lists.offsets[node];
+        const uint8_t* const stop = lists.bytes.data() + lists.offsets[node + 1];
+        uint64_t previous = 0;
+
+        if(degree && (!present[node] || weights.empty())) {
+
+            return false;
+        }
+
+        for(uint32_t group = 0; group < degree; group += 4) {
+
+            const auto count = std::min<uint32_t>(4, degree - group);
+
+            if(stop - at < (weighted ? 2 : 1)) {
+
+                return false;
+            }
+
+            const auto nodeControl = *at++;
+            const auto indexControl = weighted ? *at++ : 0;
+
+            // the controls must not claim more bytes than the list has
+            if(static_cast<unsigned>(stop - at) < measureGroup(nodeControl, count) + (weighted ? measureGroup(indexControl, count) : 0)) {
+
+                return false;
+            }
+
+            decodePartial(at, nodeControl, count, nodes);
+
+            if(weighted) {
+
+                decodePartial(at, indexControl, count, indices);
+            }
+
+            for(uint32_t lane = 0; lane < count; ++lane) {
+
+                previous += nodes[lane];
+
+                if(previous >= present.size() || !present[previous] || indices[lane] >= weights.size()) {
+
+                    return false;
+                }
+
+                if(previous != node) {
+
+                    const auto weight = weighted ? weights[indices[lane]] : weights[0];
+                    hash += forward ? hashEdge(node, previous, weight) : hashEdge(previous, node, weight);
+                    ++edges;
+                }
+            }
+        }
+
+        // and the list must be exactly as long as its encoding
+        if(at != stop) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t CompressedGraph::getBytes() const {
+
+    return present.size() / 8 + weights.size() * sizeof(Weight) + egress.getBytes() + ingress.getBytes();
+}
+
+double CompressedGraph::getBitsPerEdge() const {
+
+    return edgeCount ? 8.0 * getBytes() / edgeCount : 0.0;
+}
+
+Graph::EdgeList CompressedGraph::getEdges() const {
+
+    EdgeList ret;
+    ret.reserve(getEdgeCount());
+
+    for(Node from = 0; from < getEndNode(); ++from) {
+
+        decode(egress, from, [&ret, from](Node to, Weight weight) {
+
+            ret.push_back({from, to, weight});
+            return -1;
+        });
+    }
+
+    return ret;
+}
+
+bool CompressedGraph::haveNode(const Node node) const {
+
+    return isNode(node) && static_cast<size_t>(node) < present.size() && present[node];
+}
+
+Graph::Weight CompressedGraph::getWeight(const Node from, const Node to) const {
+
+    Weight ret = NO_WEIGHT;
+
+    // lists are sorted, so the scan stops at the first neighbour not below to
+    decode(egress, from, [&ret, to](Node node, Weight weight) -> Node {
+
+        if(node < to) {
+
+            return -1;
+        }
+
+        if(node == to) {
+
+            ret = weight;
+        }
+
+        return node;
+    });
+
+    return ret;
+}
+
+void CompressedGraph::addNode(const Node) {
+
+    assert(!"compressed graphs are read only");
+}
+
+void CompressedGraph::addEdge(const Node, const Node, const Weight) {
+
+    assert(!"compressed graphs are read only");
+}
+
+Graph::Node CompressedGraph::getNodeCount() const {
+
+    return nodeCount;
+}
+
+Graph::Node CompressedGraph::getEndNode() const {
+
+    return static_cast<Node>(present.size());
+}
+
+Graph::Node CompressedGraph::forEachNode(const NodeCall& callback) const {
+
+    Node ret = -1;
+
+    for(Node node = 0; node < getEndNode(); ++node) {
+
+        if(present[node]) {
+
+            if(ret = callback(node); isNode(ret)) {
+
+                return ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node CompressedGraph::forEachEgress(const Node from, const ProgressCall& callback) const {
+
+    return decode(egress, from, callback);
+}
+
+Graph::Node CompressedGraph::forEachIngress(const Node to, const ProgressCall& callback) const {
+
+    return decode(ingress, to, callback);
+}
+
+Graph::Node CompressedGraph::forEachLightDigress(const Node from, const ProgressCall& callback) const {
+
+    std::vector<std::pair<Node, Weight>> exits;
+    std::vector<std::pair<Node, Weight>> entries;
+
+    decode(egress, from, [&exits](Node node, Weight weight) {
+
+        exits.emplace_back(node, weight);
+        return -1;
+    });
+
+    decode(ingress, from, [&entries](Node node, Weight weight) {
+
+        entries.emplace_back(node, weight);
+        return -1;
+    });
+
+    // both lists are sorted, so a merge pairs up the neighbours joined both ways
+    Node ret = -1;
+    size_t i = 0;
+    size_t j = 0;
+
+    while(i < exits.size() || j < entries.size()) {
+
+        const bool takeExit = j == entries.size() || (i < exits.size() && exits[i].first <= entries[j].first);
+        const bool takeEntry = i == exits.size() || (j < entries.size() && entries[j].first <= exits[i].first);
+        const auto node = takeExit ? exits[i].first : entries[j].first;
+        const auto weight = takeExit && takeEntry ? std::min(exits[i].second, entries[j].second)
+            : takeExit ? exits[i].second : entries[j].second;
+
+        i += takeExit;
+        j += takeEntry;
+
+        if(ret = callback(node, weight); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+Graph::Version CompressedGraph::getVersion() const {
+
+    return version;
+}
+
+uint64_t CompressedGraph::getFingerprint() const {
+
+    return fingerprint;
+}
+
+size_t CompressedGraph::getEdgeCount() const {
+
+    return edgeCount;
+}
+
+} // namespace granky
@@ -0,0 +1,149 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_COMPRESSEDGRAPH_H
+#define GRANKY_LIB_COMPRESSEDGRAPH_H
+
+#include <cstdint> // uint8_t, uint32_t, uint64_t
+#include <istream>
+#include <ostream>
+#include <utility> // pair
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * A read-only copy of another graph, with every adjacency list compressed.
+ *
+ * Each node's egresses and ingresses are sorted, and kept as the gaps between
+ * one neighbour and the next, in Stream VByte: every group of four values has
+ * a control byte giving the length of each, from one to four bytes, so a whole
+ * group decodes with one shuffle where the processor has SSSE3, and a few
+ * shifts where it does not. Weights are kept as indices into a table of the distinct
+ * weights, encoded the same way in the same groups, and left out altogether
+ * when every edge weighs the same.
+ *
+ * Lists are decoded as they are traversed, so forEachEgress and forEachIngress
+ * cost no allocation, while getWeight costs a scan of the list. Node IDs must
+ * fit in 32 bits.
+ */
+class CompressedGraph : public Graph {
+
+public:
+    CompressedGraph() = default;
+    CompressedGraph(const CompressedGraph&) = delete;
+    CompressedGraph& operator=(const CompressedGraph&) = delete;
+    explicit CompressedGraph(const Graph& source);
+
+    /**
+     * Replaces the contents with a compressed copy of source.
+     */
+    void build(const Graph& source);
+
+    /**
+     * Whether every CompressedGraph decodes full groups with SSSE3 shuffles,
+     * which it does by default where the processor can. Turning shuffles on
+     * without SSSE3 leaves them off.
+     */
+    static bool isShuffled();
+    static void setShuffled(const bool shuffle);
+
+    /**
+     * A binary image of the compressed graph, read back by load. load returns
+     * false, leaving the graph empty, if the stream does not hold such an image.
+     */
+    void save(std::ostream& out) const;
+    bool load(std::istream& in);
+
+    /**
+     * Everything the graph keeps, and that over the number of edges, in bits.
+     */
+    size_t getBytes() const;
+    double getBitsPerEdge() const;
+
+    virtual EdgeList getEdges() const override;
+    virtual bool haveNode(const Node node) const override;
+    virtual Weight getWeight(const Node from, const Node to) const override;
+    virtual void addNode(const Node node) override;
+    virtual void addEdge(const Node from, const Node to, const Weight weight) override;
+    virtual Node getNodeCount() const override;
+    virtual Node getEndNode() const override;
+
+    virtual Node forEachNode(const NodeCall& callback) const override;
+    virtual Node forEachEgress(Node node, const ProgressCall& callback) const override;
+    virtual Node forEachIngress(Node node, const ProgressCall& callback) const override;
+    virtual Node forEachLightDigress(Node node, const ProgressCall& callback) const override;
+
+    virtual Version getVersion() const override;
+    virtual uint64_t getFingerprint() const override;
+    virtual size_t getEdgeCount() const override;
+
+private:
+    /**
+     * One direction of adjacency: every node's list starts at its offset in
+     * bytes, and holds its degree in values.
+     */
+    struct Lists {
+
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> degrees;
+        std::vector<uint8_t> bytes;
+
+        void clear();
+        size_t getBytes() const;
+    };
+
+    std::vector<bool> present;
+    std::vector<Weight> weights;
+    Lists egress;
+    Lists ingress;
+    Node nodeCount = 0;
+    Version version = drawVersion();
+    uint64_t fingerprint = 0;
+    size_t edgeCount = 0;
+
+    inline bool isWeighted() const {
+
+        return weights.size() > 1;
+    }
+
+    void clear();
+    void encode(Lists& lists, const Node node, std::vector<std::pair<Node, Weight>>& list) const;
+
+    /**
+     * Whether every list of a loaded image decodes within its own bytes, to
+     * present nodes and to weights in the table, counting and hashing its edges
+     * as egresses if forward, and as ingresses if not.
+     */
+    bool check(const Lists& lists, const bool forward, size_t& edges, uint64_t& hash) const;
+
+    /**
+     * Calls back with every neighbour in a list, in order, stopping as forEach does.
+     */
+    template<class CALL>
+    Node decode(const Lists& lists, const Node node, CALL&& call) const;
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_COMPRESSEDGRAPH_H
@@ -0,0 +1,782 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cstdint> // uint64_t
+#include <cstring> // memcmp
+
+#include <algorithm> // push_heap, pop_heap
+#include <functional> // greater
+#include <utility> // pair
+
+#include "ContractionHierarchy.h"
+
+namespace granky {
+
+namespace {
+
+const char MAGIC[8] = {'G', 'K', 'Y', 'C', 'H', 0, 0, 2};
+
+typedef ContractionHierarchy::Arc Arc;
+typedef std::pair<Graph::Weight, Graph::Node> Rated;
+
+/**
+ * The graph that remains while nodes are being contracted, with every
+ * original edge and every shortcut added so far.
+ */
+struct Overlay {
+
+    std::vector<std::vector<Arc>> out;
+    std::vector<std::vector<Arc>> in;
+
+    void link(const Graph::Node from, const Graph::Node to, const Graph::Weight weight, const Graph::Node middle) {
+
+        for(auto& each : out[from]) {
+
+            if(each.to != to) {
+
+                continue;
+            }
+
+            if(weight < each.weight) {
+
+                each = {to, weight, middle};
+
+                for(auto& back : in[to]) {
+
+                    if(back.to == from) {
+
+                        back = {from, weight, middle};
+                    }
+                }
+            }
+
+            return;
+        }
+
+        out[from].push_back({to, weight, middle});
+        in[to].push_back({from, weight, middle});
+    }
+};
+
+/**
+ * Contracts nodes of an Overlay, deciding which shortcuts each contraction needs
+ * through a bounded local Dijkstra search for a witness path.
+ */
+struct Contractor {
+
+    Overlay overlay;
+    std::vector<bool> contracted;
+    std::vector<Graph::Node> removed;
+    std::vector<Graph::Weight> distance;
+    std::vector<Graph::Node> touched;
+    std::vector<Rated> heap;
+    size_t limit;
+
+    void witness(const Graph::Node from, const Graph::Node skip, const Graph::Weight bound) {
+
+        for(const auto each : touched) {
+
+            distance[each] = Graph::NO_WEIGHT;
+        }
+
+        touched.clear();
+        heap.clear();
+
+        distance[from] = 0.0;
+        touched.push_back(from);
+        heap.push_back({0.0, from});
+
+        for(size_t settled = 0; !heap.empty() && settled < limit;) {
+
+            std::pop_heap(heap.begin(), heap.end(), std::greater<Rated>());
+            const auto top = heap.back();
+            heap.pop_back();
+
+            if(top.first > distance[top.second]) {
+
+                continue;
+            }
+
+            if(top.first > bound) {
+
+                break;
+            }
+
+            ++settled;
+
+            for(const auto& each : overlay.out[top.second]) {
+
+                if(each.to == skip || contracted[each.to]) {
+
+                    continue;
+                }
+
+                const auto reach = top.first + each.weight;
+                const auto known = distance[each.to];
+
+                if(Graph::isWeight(known) && known <= reach) {
+
+                    continue;
+                }
+
+                if(!Graph::isWeight(known)) {
+
+                    touched.push_back(each.to);
+                }
+
+                distance[each.to] = reach;
+                heap.push_back({reach, each.to});
+                std::push_heap(heap.begin(), heap.end(), std::greater<Rated>());
+            }
+        }
+    }
+
+    /**
+     * Counts, and when apply is set adds, the shortcuts needed to contract a node.
+     */
+    Graph::Node contract(const Graph::Node node, const bool apply) {
+
+        Graph::Node ret = 0;
+
+        // links may be added to the lists of neighbours, but never to those of this node
+        const auto& ins = overlay.in[node];
+        const auto& outs = overlay.out[node];
+
+        for(const auto& in : ins) {
+
+            if(contracted[in.to]) {
+
+                continue;
+            }
+
+            Graph::Weight bound = -Graph::MAX_WEIGHT;
+
+            for(const auto& out : outs) {
+
+                if(out.to != in.to && !contracted[out.to]) {
+
+                    bound = std::max(bound, in.weight + out.weight);
+                }
+            }
+
+            if(bound == -Graph::MAX_WEIGHT) {
+
+                continue;
+            }
+
+            witness(in.to, node, bound);
+
+            for(const auto& out : outs) {
+
+                if(out.to == in.to || contracted[out.to]) {
+
+                    continue;
+                }
+
+                const auto through = in.weight + out.weight;
+
+                if(const auto known = distance[out.to]; Graph::isWeight(known) && known <= through) {
+
+                    continue;
+                }
+
+                ++ret;
+
+                if(apply) {
+
+                    overlay.link(in.to, out.to, through, node);
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    Graph::Weight prioritise(const Graph::Node node) {
+
+        Graph::Node degree = 0;
+
+        for(const auto& each : overlay.in[node]) {
+
+            degree += contracted[each.to] ? 0 : 1;
+        }
+
+        for(const auto& each : overlay.out[node]) {
+
+            degree += contracted[each.to] ? 0 : 1;
+        }
+
+        return contract(node, false) - degree + removed[node];
+    }
+};
+
+} // namespace
+
+void ContractionHierarchy::build(const Graph& graph) {
+
+    GRANKY_TRACE("ContractionHierarchy::build");
+    const auto end = graph.getEndNode();
+
+    Contractor contractor;
+    contractor.overlay.out.resize(end);
+    contractor.overlay.in.resize(end);
+    contractor.contracted.assign(end, false);
+    contractor.removed.assign(end, 0);
+    contractor.distance.assign(end, Graph::NO_WEIGHT);
+    contractor.limit = witnessLimit;
+
+    rank.assign(end, -1);
+
+    const Graph::EdgeCall edgeCall = [&contractor](Graph::Node from, Graph::Node to, Graph::Weight weight) {
+
+        if(from != to) {
+
+            contractor.overlay.link(from, to, weight, -1);
+        }
+
+        return -1;
+    };
+
+    graph.forEachEdge(edgeCall);
+
+    std::vector<Rated> queue;
+
+    const Graph::NodeCall nodeCall = [&contractor, &queue](Graph::Node node) {
+
+        queue.push_back({contractor.prioritise(node), node});
+        return -1;
+    };
+
+    graph.forEachNode(nodeCall);
+    std::make_heap(queue.begin(), queue.end(), std::greater<Rated>());
+
+    for(Graph::Node order = 0; !queue.empty();) {
+
+        std::pop_heap(queue.begin(), queue.end(), std::greater<Rated>());
+        const auto node = queue.back().second;
+        queue.pop_back();
+
+        // priorities go stale as neighbours are contracted, so they are checked lazily
+        const auto priority = contractor.prioritise(node);
+
+        if(!queue.empty() && priority > queue.front().first) {
+
+            queue.push_back({priority, node});
+            std::push_heap(queue.begin(), queue.end(), std::greater<Rated>());
+            continue;
+        }
+
+        contractor.contract(node, true);
+        contractor.contracted[node] = true;
+        rank[node] = order++;
+
+        for(const auto& each : contractor.overlay.in[node]) {
+
+            ++contractor.removed[each.to];
+        }
+
+        for(const auto& each : contractor.overlay.out[node]) {
+
+            ++contractor.removed[each.to];
+        }
+    }
+
+    forwardOffset.assign(end + 1, 0);
+    backwardOffset.assign(end + 1, 0);
+
+    for(Graph::Node from = 0; from < end; ++from) {
+
+        for(const auto& each : contractor.overlay.out[from]) {
+
+            ++(rank[each.to] > rank[from] ? forwardOffset[from + 1] : backwardOffset[each.to + 1]);
+        }
+    }
+
+    for(Graph::Node node = 0; node < end; ++node) {
+
+        forwardOffset[node + 1] += forwardOffset[node];
+        backwardOffset[node + 1] += backwardOffset[node];
+    }
+
+    forwardArcs.resize(forwardOffset[end]);
+    backwardArcs.resize(backwardOffset[end]);
+
+    auto forwardFill = forwardOffset;
+    auto backwardFill = backwardOffset;
+
+    for(Graph::Node from = 0; from < end; ++from) {
+
+        for(const auto& each : contractor.overlay.out[from]) {
+
+            if(rank[each.to] > rank[from]) {
+
+                forwardArcs[forwardFill[from]++] = each;
+            }
+            else {
+
+                backwardArcs[backwardFill[each.to]++] = {from, each.weight, each.middle};
+            }
+        }
+    }
+}
+
+template<class T>
+static void writeRaw(std::ostream& out, const T& value) {
+
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<class T>
+static bool readRaw(std::istream& in, T& value) {
+
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template<class T>
+static void writeVector(std::ostream& out, const std::vector<T>& data) {
+
+    writeRaw(out, static_cast<uint64_t>(data.size()));
+    out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+}
+
+template<class T>
+static bool readVector(std::istream& in, std::vector<T>& data) {
+
+    uint64_t size = 0;
+
+    if(!readRaw(in, size)) {
+
+        return false;
+    }
+
+    // read in pieces, so that a corrupt size runs out of stream before it runs out of memory
+    const uint64_t piece = (1 << 20) / sizeof(T);
+    data.clear();
+
+    while(data.size() < size) {
+
+        const auto at = data.size();
+        data.resize(at + std::min<uint64_t>(piece, size - at));
+
+        if(!in.read(reinterpret_cast<char*>(data.data() + at), (data.size() - at) * sizeof(T))) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Arcs are written field by field, so that their padding never reaches the stream.
+ */
+static void writeArcs(std::ostream& out, const std::vector<Arc>& arcs) {
+
+    writeRaw(out, static_cast<uint64_t>(arcs.size()));
+
+    for(const auto& each : arcs) {
+
+        writeRaw(out, each.to);
+        writeRaw(out, each.weight);
+        writeRaw(out, each.middle);
+    }
+}
+
+static bool readArcs(std::istream& in, std::vector<Arc>& arcs) {
+
+    uint64_t size = 0;
+
+    if(!readRaw(in, size)) {
+
+        return false;
+    }
+
+    arcs.clear();
+
+    for(uint64_t i = 0; i < size; ++i) {
+
+        Arc arc;
+
+        if(!readRaw(in, arc.to) || !readRaw(in, arc.weight) || !readRaw(in, arc.middle)) {
+
+            return false;
+        }
+
+        arcs.push_back(arc);
+    }
+
+    return true;
+}
+
+/**
+ * Whether absent nodes are unranked, and no two nodes share a rank.
+ */
+static bool checkRanks(const std::vector<Graph::Node>& rank) {
+
+    std::vector<bool> ranked(rank.size(), false);
+
+    for(const auto each : rank) {
+
+        if(Graph::isNode(each)) {
+
+            if(static_cast<size_t>(each) >= rank.size() || ranked[each]) {
+
+                return false;
+            }
+
+            ranked[each] = true;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Whether offsets rise from zero to the number of arcs, and every arc leads
+ * upward in rank to a node of the hierarchy, through a middle ranked below
+ * both ends if it is a shortcut. Unpacking a path then always terminates.
+ */
+static bool checkArcs(const std::vector<uint64_t>& offsets, const std::vector<Arc>& arcs, const std::vector<Graph::Node>& rank) {
+
+    const uint64_t end = rank.size();
+
+    if(offsets.size() != end + 1 || offsets.front() != 0 || offsets.back() != arcs.size()) {
+
+        return false;
+    }
+
+    for(uint64_t i = 0; i < end; ++i) {
+
+        if(offsets[i] > offsets[i + 1]) {
+
+            return false;
+        }
+
+        for(auto at = offsets[i]; at < offsets[i + 1]; ++at) {
+
+            const auto& arc = arcs[at];
+
+            if(!Graph::isNode(rank[i]) || !Graph::isNode(arc.to) || static_cast<uint64_t>(arc.to) >= end
+                || rank[arc.to] <= rank[i]) {
+
+                return false;
+            }
+
+            if(Graph::isNode(arc.middle) && (static_cast<uint64_t>(arc.middle) >= end
+                || !Graph::isNode(rank[arc.middle]) || rank[arc.middle] >= rank[i])) {
+
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void ContractionHierarchy::save(std::ostream& out) const {
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writeRaw(out, static_cast<uint32_t>(sizeof(Graph::Node)));
+    writeRaw(out, static_cast<uint32_t>(sizeof(Graph::Weight)));
+    writeVector(out, rank);
+    writeVector(out, std::vector<uint64_t>(forwardOffset.begin(), forwardOffset.end()));
+    writeArcs(out, forwardArcs);
+    writeVector(out, std::vector<uint64_t>(backwardOffset.begin(), backwardOffset.end()));
+    writeArcs(out, backwardArcs);
+}
+
+bool ContractionHierarchy::load(std::istream& in) {
+
+    char magic[sizeof(MAGIC)];
+    uint32_t nodeSize = 0;
+    uint32_t weightSize = 0;
+    std::vector<uint64_t> forwardOffsets;
+    std::vector<uint64_t> backwardOffsets;
+
+    const bool ret = in.read(magic, sizeof(magic)) && !memcmp(magic, MAGIC, sizeof(MAGIC))
+        && readRaw(in, nodeSize) && nodeSize == sizeof(Graph::Node)
+        && readRaw(in, weightSize) && weightSize == sizeof(Graph::Weight)
+        && readVector(in, rank)
+        && readVector(in, forwardOffsets)
+        && readArcs(in, forwardArcs)
+        && readVector(in, backwardOffsets)
+        && readArcs(in, backwardArcs)
+        && checkRanks(rank)
+        && checkArcs(forwardOffsets, forwardArcs, rank)
+        && checkArcs(backwardOffsets, backwardArcs, rank);
+
+    if(!ret) {
+
+        *this = ContractionHierarchy();
+        return false;
+    }
+
+    forwardOffset.assign(forwardOffsets.begin(), forwardOffsets.end());
+    backwardOffset.assign(backwardOffsets.begin(), backwardOffsets.end());
+    return true;
+}
+
+Graph::Node ContractionHierarchy::getEndNode() const {
+
+    return static_cast<Graph::Node>(rank.size());
+}
+
+Graph::Node ContractionHierarchy::getRank(const Graph::Node node) const {
+
+    return Graph::isNode(node) && node < getEndNode() ? rank[node] : -1;
+}
+
+size_t ContractionHierarchy::getArcCount() const {
+
+    return forwardArcs.size() + backwardArcs.size();
+}
+
+size_t ContractionHierarchy::getShortcutCount() const {
+
+    size_t ret = 0;
+
+    for(const auto& each : forwardArcs) {
+
+        ret += Graph::isNode(each.middle) ? 1 : 0;
+    }
+
+    for(const auto& each : backwardArcs) {
+
+        ret += Graph::isNode(each.middle) ? 1 : 0;
+    }
+
+    return ret;
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::beginUp(const Graph::Node node, const bool forward) const {
+
+    return forward ? forwardArcs.data() + forwardOffset[node] : backwardArcs.data() + backwardOffset[node];
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::endUp(const Graph::Node node, const bool forward) const {
+
+    return forward ? forwardArcs.data() + forwardOffset[node + 1] : backwardArcs.data() + backwardOffset[node + 1];
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::findArc(const Graph::Node from, const Graph::Node to) const {
+
+    const bool forward = rank[to] > rank[from];
+    const auto at = forward ? from : to;
+    const auto other = forward ? to : from;
+
+    for(auto it = beginUp(at, forward); it != endUp(at, forward); ++it) {
+
+        if(it->to == other) {
+
+            return it;
+        }
+    }
+
+    return nullptr;
+}
+
+HierarchyQuery::HierarchyQuery(const ContractionHierarchy& h) : hierarchy(h) {}
+
+void HierarchyQuery::init(Graph* g) {
+
+    GRANKY_PHASE("init");
+    graph = g;
+    forward.reserve(hierarchy.getEndNode());
+    backward.reserve(hierarchy.getEndNode());
+}
+
+void HierarchyQuery::execute() {
+
+    GRANKY_PHASE("execute");
+    GRANKY_TRACE("HierarchyQuery::execute");
+    cachedTable.reset();
+    assert(Graph::isNode(source) && Graph::isNode(sink));
+
+    forward.reset();
+    backward.reset();
+    forward.reserve(hierarchy.getEndNode());
+    backward.reserve(hierarchy.getEndNode());
+
+    node = -1;
+    weight = Graph::NO_WEIGHT;
+    expanded = 0;
+    sequence.clear();
+
+    if(!Graph::isNode(hierarchy.getRank(source)) || !Graph::isNode(hierarchy.getRank(sink))) {
+
+        return;
+    }
+
+    Graph::Weight best = Graph::MAX_WEIGHT;
+    Graph::Node meet = -1;
+
+    forward.visit(source, source, 0.0);
+    backward.visit(sink, sink, 0.0);
+
+    while(!forward.heap.empty() || !backward.heap.empty()) {
+
+        const bool isForward = backward.heap.empty()
+            || (!forward.heap.empty() && forward.heap.front().reach <= backward.heap.front().reach);
+        auto& side = isForward ? forward : backward;
+        auto& other = isForward ? backward : forward;
+
+        std::pop_heap(side.heap.begin(), side.heap.end(), std::greater<Entry>());
+        const auto top = side.heap.back();
+        side.heap.pop_back();
+
+        // an upward search can stop as soon as it cannot improve the best meeting
+        if(top.reach >= best) {
+
+            side.heap.clear();
+            continue;
+        }
+
+        if(top.reach > side.distance[top.node]) {
+
+            continue;
+        }
+
+        ++expanded;
+        GRANKY_STAT(visited, 1);
+
+        if(const auto rest = other.distance[top.node]; Graph::isWeight(rest) && top.reach + rest < best) {
+
+            best = top.reach + rest;
+            meet = top.node;
+        }
+
+        for(auto it = hierarchy.beginUp(top.node, isForward); it != hierarchy.endUp(top.node, isForward); ++it) {
+
+            GRANKY_STAT(examined, 1);
+            side.visit(it->to, top.node, top.reach + it->weight);
+        }
+    }
+
+    if(!Graph::isNode(meet)) {
+
+        return;
+    }
+
+    node = sink;
+    weight = best;
+
+    Graph::Node from = source;
+    chain.clear();
+
+    // the forward half is walked from the meeting node back, so it is stacked first
+    for(Graph::Node at = meet; at != source; at = forward.parent[at]) {
+
+        chain.push_back(at);
+    }
+
+    bool unpacked = true;
+
+    for(auto it = chain.rbegin(); unpacked && it != chain.rend(); ++it) {
+
+        unpacked = unpack(from, *it);
+        from = *it;
+    }
+
+    for(Graph::Node at = meet; unpacked && at != sink; at = backward.parent[at]) {
+
+        unpacked = unpack(at, backward.parent[at]);
+    }
+
+    // a shortcut whose halves are missing leaves no path to report
+    if(!unpacked) {
+
+        node = -1;
+        weight = Graph::NO_WEIGHT;
+        sequence.clear();
+    }
+}
+
+Graph::Node HierarchyQuery::yieldExpanded() const {
+
+    return expanded;
+}
+
+bool HierarchyQuery::isCacheable() const {
+
+    return false;
+}
+
+bool HierarchyQuery::unpack(const Graph::Node from, const Graph::Node to) {
+
+    const auto arc = hierarchy.findArc(from, to);
+
+    if(!arc) {
+
+        return false;
+    }
+
+    if(!Graph::isNode(arc->middle)) {
+
+        sequence.push_back({from, to, arc->weight});
+        return true;
+    }
+
+    return unpack(from, arc->middle) && unpack(arc->middle, to);
+}
+
+void HierarchyQuery::Side::reserve(const size_t end) {
+
+    if(distance.size() < end) {
+
+        distance.resize(end, Graph::NO_WEIGHT);
+        parent.resize(end, -1);
+    }
+}
+
+void HierarchyQuery::Side::reset() {
+
+    for(const auto each : touched) {
+
+        distance[each] = Graph::NO_WEIGHT;
+        parent[each] = -1;
+    }
+
+    touched.clear();
+    heap.clear();
+}
+
+void HierarchyQuery::Side::visit(const Graph::Node to, const Graph::Node from, const Graph::Weight w) {
+
+    const auto known = distance[to];
+
+    if(Graph::isWeight(known) && known <= w) {
+
+        return;
+    }
+
+    if(!Graph::isWeight(known)) {
+
+        touched.push_back(to);
+    }
+
+    distance[to] = w;
+    parent[to] = from;
+    heap.push_back({w, to});
+    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+}
+
+} // namespace granky
@@ -0,0 +1,167 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_CONTRACTIONHIERARCHY_H
+#define GRANKY_LIB_CONTRACTIONHIERARCHY_H
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "Graph.h"
+#include "Query.h"
+
+/**
+ * LEXICON
+ *
+ * Rank: the position of a node in contraction order. Nodes contracted later are more important.
+ * Shortcut: an edge added while contracting a node, standing for the two edges through it.
+ * Middle: the contracted node a shortcut stands in for, or a leaf for an original edge.
+ * Upward: an edge leading from a node to a node of higher rank.
+ */
+
+namespace granky {
+
+/**
+ * A contraction hierarchy built from a Graph.
+ *
+ * Nodes are contracted one by one, least important first, as ranked by
+ * edge difference plus the number of already contracted neighbours. Whenever
+ * contracting a node would break a shortest path between two of its
+ * neighbours, a shortcut is added. The result keeps, for every node, its
+ * upward egresses and its upward ingresses in flat arrays.
+ *
+ * A hierarchy only describes the graph as it was when build was called.
+ */
+class ContractionHierarchy {
+
+public:
+    struct Arc {
+
+        Graph::Node to;
+        Graph::Weight weight;
+        Graph::Node middle;
+    };
+
+    void build(const Graph& graph);
+
+    /**
+     * Binary serialisation, for loading a prebuilt hierarchy at startup.
+     * The format is native endian, tagged with the sizes of Node and Weight,
+     * and load returns false, leaving the hierarchy empty, on a malformed stream.
+     */
+    void save(std::ostream& out) const;
+    bool load(std::istream& in);
+
+    Graph::Node getEndNode() const;
+    Graph::Node getRank(const Graph::Node node) const;
+    size_t getArcCount() const;
+    size_t getShortcutCount() const;
+
+    /**
+     * Upward egresses of a node in forward, and upward ingresses in backward,
+     * where Arc::to is the node at the other end.
+     */
+    const Arc* beginUp(const Graph::Node node, const bool forward) const;
+    const Arc* endUp(const Graph::Node node, const bool forward) const;
+
+    /**
+     * Finds the arc from one node to another, or nullptr if there is none.
+     */
+    const Arc* findArc(const Graph::Node from, const Graph::Node to) const;
+
+    static constexpr const size_t DEFAULT_WITNESS_LIMIT = 64;
+
+    /**
+     * The most nodes a witness search settles before giving up and adding a shortcut.
+     * Lower limits build faster but add more, unnecessary, shortcuts.
+     */
+    size_t witnessLimit = DEFAULT_WITNESS_LIMIT;
+
+private:
+    std::vector<Graph::Node> rank;
+    std::vector<size_t> forwardOffset;
+    std::vector<Arc> forwardArcs;
+    std::vector<size_t> backwardOffset;
+    std::vector<Arc> backwardArcs;
+};
+
+/**
+ * A point-to-point shortest path query over a ContractionHierarchy.
+ *
+ * Runs two upward searches, forward from the source and backward from the
+ * sink, and unpacks the shortcuts of the best meeting path into yieldSequence.
+ * The graph passed to init is not read, and may be nullptr; yieldTable is always nullptr.
+ * Since the graph's version says nothing of the hierarchy, a QueryCache always executes it.
+ */
+class HierarchyQuery : public Query {
+
+public:
+    explicit HierarchyQuery(const ContractionHierarchy& hierarchy);
+    virtual void init(Graph* graph) override;
+    virtual void execute() override;
+
+    /**
+     * The number of nodes expanded by both sides of the last execute.
+     */
+    Graph::Node yieldExpanded() const;
+
+    virtual bool isCacheable() const override;
+
+private:
+    struct Entry {
+
+        Graph::Weight reach;
+        Graph::Node node;
+
+        inline bool operator > (const Entry& other) const {
+
+            return reach > other.reach;
+        }
+    };
+
+    struct Side {
+
+        std::vector<Entry> heap;
+        std::vector<Graph::Weight> distance;
+        std::vector<Graph::Node> parent;
+        std::vector<Graph::Node> touched;
+
+        void reserve(const size_t end);
+        void reset();
+        void visit(const Graph::Node node, const Graph::Node from, const Graph::Weight w);
+    };
+
+    const ContractionHierarchy& hierarchy;
+    Side forward;
+    Side backward;
+    std::vector<Graph::Node> chain;
+    Graph::Node expanded = 0;
+
+    /**
+     * Appends the original edges behind an arc to sequence, or returns false if an arc is missing.
+     */
+    bool unpack(const Graph::Node from, const Graph::Node to);
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_CONTRACTIONHIERARCHY_H
@@ -0,0 +1,215 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+
+#include <algorithm> // push_heap, pop_heap, fill, max, reverse
+#include <functional> // greater
+
+#include "DynamicShortestPaths.h"
+
+namespace granky {
+
+DynamicShortestPaths::~DynamicShortestPaths() {
+
+    if(graph) {
+
+        graph->detach(this);
+    }
+}
+
+void DynamicShortestPaths::init(Graph* g) {
+
+    GRANKY_PHASE("init");
+    assert(g);
+
+    if(graph) {
+
+        graph->detach(this);
+    }
+
+    graph = g;
+    dirty = true;
+    distance.clear();
+    heap.clear();
+    table = nullptr;
+    reserve(graph->getEndNode());
+
+    relax = [this](Graph::Node to, Graph::Weight w) {
+
+        GRANKY_STAT(examined, 1);
+        GRANKY_STAT(callbacks, 1);
+        offer(to, current, distance[current] + w);
+        return -1;
+    };
+
+    graph->attach(this);
+}
+
+void DynamicShortestPaths::execute() {
+
+    GRANKY_PHASE("execute");
+    GRANKY_TRACE("DynamicShortestPaths::execute");
+    cachedTable.reset();
+    assert(graph && Graph::isNode(source));
+
+    reserve(graph->getEndNode());
+    settled = 0;
+
+    if(dirty || source != root) {
+
+        std::fill(distance.begin(), distance.end(), Graph::NO_WEIGHT);
+
+        for(Graph::Node each = 0; static_cast<size_t>(each) < distance.size(); ++each) {
+
+            table->set(each, -1);
+        }
+
+        heap.clear();
+        root = source;
+        dirty = false;
+
+        if(graph->haveNode(root)) {
+
+            offer(root, root, 0.0);
+        }
+    }
+
+    while(!heap.empty()) {
+
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        const auto top = heap.back();
+        heap.pop_back();
+
+        if(top.reach > distance[top.node]) {
+
+            continue;
+        }
+
+        ++settled;
+        GRANKY_STAT(visited, 1);
+        current = top.node;
+        graph->forEachEgress(current, relax);
+    }
+
+    node = -1;
+    weight = Graph::NO_WEIGHT;
+    sequence.clear();
+
+    if(!Graph::isNode(sink) || static_cast<size_t>(sink) >= distance.size() || !Graph::isWeight(distance[sink])) {
+
+        return;
+    }
+
+    node = sink;
+    weight = distance[sink];
+
+    for(Graph::Node to = sink; to != root;) {
+
+        const auto from = table->get(to);
+        sequence.push_back({from, to, graph->getWeight(from, to)});
+        to = from;
+    }
+
+    std::reverse(sequence.begin(), sequence.end());
+}
+
+void DynamicShortestPaths::onNode(const Graph::Node n) {
+
+    reserve(n + 1);
+}
+
+void DynamicShortestPaths::onEdge(const Graph::Node from, const Graph::Node to, const Graph::Weight previous, const Graph::Weight w) {
+
+    if(dirty) {
+
+        return;
+    }
+
+    if(Graph::isWeight(previous) && w >= previous) {
+
+        // a heavier tree edge can lengthen every path below it
+        if(w > previous && table->get(to) == from) {
+
+            dirty = true;
+        }
+
+        return;
+    }
+
+    if(Graph::isWeight(distance[from])) {
+
+        offer(to, from, distance[from] + w);
+    }
+}
+
+Graph::Weight DynamicShortestPaths::yieldDistance(const Graph::Node n) const {
+
+    return Graph::isNode(n) && static_cast<size_t>(n) < distance.size() && !dirty ? distance[n] : Graph::NO_WEIGHT;
+}
+
+Graph::Node DynamicShortestPaths::yieldSettled() const {
+
+    return settled;
+}
+
+bool DynamicShortestPaths::isCacheable() const {
+
+    return false;
+}
+
+void DynamicShortestPaths::reserve(const Graph::Node end) {
+
+    if(static_cast<size_t>(end) <= distance.size()) {
+
+        return;
+    }
+
+    // grown geometrically, since nodes may arrive one at a time
+    const auto size = std::max<size_t>(end, distance.size() * 2);
+    auto grown = Graph::Table::create<Graph::NodeTally>(size);
+    GRANKY_STAT(allocations, 1);
+
+    for(Graph::Node each = 0; table && static_cast<size_t>(each) < distance.size(); ++each) {
+
+        grown->set(each, table->get(each));
+    }
+
+    distance.resize(size, Graph::NO_WEIGHT);
+    table = std::move(grown);
+}
+
+void DynamicShortestPaths::offer(const Graph::Node to, const Graph::Node from, const Graph::Weight w) {
+
+    const auto known = distance[to];
+
+    if(Graph::isWeight(known) && known <= w) {
+
+        return;
+    }
+
+    distance[to] = w;
+    table->set(to, from);
+    heap.push_back({w, to});
+    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+}
+
+} // namespace granky
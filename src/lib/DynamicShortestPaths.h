@@ -0,0 +1,102 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_DYNAMICSHORTESTPATHS_H
+#define GRANKY_LIB_DYNAMICSHORTESTPATHS_H
+
+#include <vector>
+
+#include "Query.h"
+
+namespace granky {
+
+/**
+ * A single source shortest path tree that is repaired, rather than rebuilt,
+ * as edges are inserted or made lighter.
+ *
+ * init attaches the query to a graph as an Observer. Each inserted or
+ * lightened edge that shortens the way to its head queues that node, and
+ * the next execute runs Dijkstra outwards from the queued nodes only, in
+ * the manner of Ramalingam and Reps. Making a tree edge heavier, or moving
+ * the source, falls back to a full run on the next execute.
+ *
+ * Results:
+ * * yieldWeight: the distance to the sink, or Graph::NO_WEIGHT if it is unreachable or unset.
+ * * yieldNode: the sink if it is reachable, otherwise -1.
+ * * yieldSequence: the shortest path from source to sink.
+ * * yieldTable: the parent of every reachable node, the source being its own parent.
+ *
+ * The graph must outlive the query, or the query must be reinitialised first.
+ */
+class DynamicShortestPaths : public Query, public Graph::Observer {
+
+public:
+    DynamicShortestPaths() = default;
+    DynamicShortestPaths(const DynamicShortestPaths&) = delete;
+    DynamicShortestPaths& operator=(const DynamicShortestPaths&) = delete;
+    virtual ~DynamicShortestPaths();
+
+    virtual void init(Graph* graph) override;
+    virtual void execute() override;
+
+    virtual void onNode(const Graph::Node node) override;
+    virtual void onEdge(const Graph::Node from, const Graph::Node to, const Graph::Weight previous, const Graph::Weight weight) override;
+
+    Graph::Weight yieldDistance(const Graph::Node node) const;
+
+    /**
+     * The number of nodes settled by the last execute, which is every
+     * reachable node after a full run, and only the affected ones after a repair.
+     */
+    Graph::Node yieldSettled() const;
+
+    /**
+     * Distances are incremental state, so a QueryCache may not stand in for execute.
+     */
+    virtual bool isCacheable() const override;
+
+private:
+    struct Entry {
+
+        Graph::Weight reach;
+        Graph::Node node;
+
+        inline bool operator > (const Entry& other) const {
+
+            return reach > other.reach;
+        }
+    };
+
+    std::vector<Graph::Weight> distance;
+    std::vector<Entry> heap;
+    Graph::ProgressCall relax;
+    Graph::Node root = -1;
+    Graph::Node current = -1;
+    Graph::Node settled = 0;
+    bool dirty = true;
+
+    void reserve(const Graph::Node end);
+    void offer(const Graph::Node node, const Graph::Node from, const Graph::Weight w);
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_DYNAMICSHORTESTPATHS_H
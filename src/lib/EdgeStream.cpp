@@ -0,0 +1,280 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+
+#include <algorithm> // max
+#include <charconv> // from_chars
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "EdgeStream.h"
+#include "Trace.h"
+
+namespace granky {
+
+namespace {
+
+struct Batch {
+
+    Graph::EdgeList edges;
+    uint64_t lines = 0;
+    EdgeStream::Clock::time_point start;
+};
+
+/**
+ * Skips spaces and tabs, then parses one number. Returns false if there is none.
+ */
+template<typename NUMBER>
+bool parseNumber(const char*& at, const char* end, NUMBER& out) {
+
+    while(at < end && (*at == ' ' || *at == '\t' || *at == '\r')) {
+
+        ++at;
+    }
+
+    const auto result = std::from_chars(at, end, out);
+
+    if(result.ec != std::errc()) {
+
+        return false;
+    }
+
+    at = result.ptr;
+    return true;
+}
+
+} // namespace
+
+double EdgeStream::Stats::getEdgesPerSecond() const {
+
+    return seconds > 0 ? edges / seconds : 0.0;
+}
+
+EdgeStream::EdgeStream(Graph& g, const size_t b, const size_t c) :
+    graph(g), batchSize(std::max<size_t>(b, 1)), capacity(std::max<size_t>(c, 1)) {}
+
+void EdgeStream::addQuery(Query* query) {
+
+    assert(query);
+    queries.push_back(query);
+}
+
+void EdgeStream::setInterval(const uint64_t edges, const std::chrono::milliseconds time) {
+
+    everyEdges = edges;
+    everyTime = time;
+}
+
+void EdgeStream::setReport(const ReportCall& r) {
+
+    report = r;
+}
+
+bool EdgeStream::parseLine(const std::string_view line, Graph::Edge& edge) {
+
+    const char* at = line.data();
+    const char* end = at + line.size();
+    edge = {-1, -1, Graph::DEFAULT_DEFAULT_WEIGHT};
+
+    if(!parseNumber(at, end, edge.from) || !Graph::isNode(edge.from)) {
+
+        return false;
+    }
+
+    if(parseNumber(at, end, edge.to)) {
+
+        parseNumber(at, end, edge.weight);
+    }
+
+    return true;
+}
+
+EdgeStream::Stats EdgeStream::run(std::istream& in) {
+
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<Batch> queue;
+    bool done = false;
+
+    const auto hand = [&](Batch& batch) {
+
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&]() { return queue.size() < capacity; });
+        queue.push_back(std::move(batch));
+        notEmpty.notify_one();
+        batch = Batch();
+    };
+
+    std::thread reader([&]() {
+
+        Batch batch;
+        std::string line;
+
+        while(std::getline(in, line)) {
+
+            if(!batch.lines++) {
+
+                batch.start = Clock::now();
+                batch.edges.reserve(batchSize);
+            }
+
+            if(Graph::Edge edge; parseLine(line, edge)) {
+
+                batch.edges.push_back(edge);
+            }
+
+            // nothing buffered means the next line may be a long time coming
+            if(batch.edges.size() >= batchSize || in.rdbuf()->in_avail() <= 0) {
+
+                hand(batch);
+            }
+        }
+
+        if(batch.lines) {
+
+            hand(batch);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        notEmpty.notify_one();
+    });
+
+    Stats stats;
+    double latency = 0.0;
+    uint64_t pending = 0;
+    bool changed = false;
+    const auto start = Clock::now();
+    auto lastRound = start;
+
+    const auto round = [&]() {
+
+        for(const auto each : queries) {
+
+            each->init(&graph);
+            each->execute();
+        }
+
+        lastRound = Clock::now();
+        stats.seconds = std::chrono::duration<double>(lastRound - start).count();
+        ++stats.rounds;
+        pending = 0;
+        changed = false;
+
+        if(report) {
+
+            report(stats);
+        }
+    };
+
+    while(true) {
+
+        std::unique_lock<std::mutex> lock(mutex);
+        const auto ready = [&]() { return !queue.empty() || done; };
+
+        if(everyTime.count() > 0) {
+
+            notEmpty.wait_until(lock, lastRound + everyTime, ready);
+        }
+        else {
+
+            notEmpty.wait(lock, ready);
+        }
+
+        if(queue.empty()) {
+
+            if(done) {
+
+                break;
+            }
+
+            // the stream has gone quiet, but the time is up all the same
+            lock.unlock();
+
+            if(changed) {
+
+                round();
+            }
+            else {
+
+                lastRound = Clock::now();
+            }
+
+            continue;
+        }
+
+        Batch batch = std::move(queue.front());
+        queue.pop_front();
+        notFull.notify_one();
+        lock.unlock();
+
+        uint64_t edges = 0;
+
+        {
+            GRANKY_TRACE("EdgeStream::apply");
+
+            for(const auto& each : batch.edges) {
+
+                if(Graph::isNode(each.to)) {
+
+                    graph.addEdge(each.from, each.to, each.weight);
+                    ++edges;
+                }
+                else {
+
+                    graph.addNode(each.from);
+                }
+            }
+        }
+
+        const auto now = Clock::now();
+        const auto delay = std::chrono::duration<double>(now - batch.start).count();
+        latency += delay;
+        stats.lines += batch.lines;
+        stats.edges += edges;
+        stats.maxLatency = std::max(stats.maxLatency, delay);
+        stats.meanLatency = latency / ++stats.batches;
+        pending += edges;
+        changed = true;
+
+        if((everyEdges && pending >= everyEdges) || (everyTime.count() > 0 && now - lastRound >= everyTime)) {
+
+            round();
+        }
+    }
+
+    reader.join();
+
+    if(changed) {
+
+        round();
+    }
+
+    stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return stats;
+}
+
+} // namespace granky
@@ -0,0 +1,114 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_EDGESTREAM_H
+#define GRANKY_LIB_EDGESTREAM_H
+
+#include <chrono>
+#include <cstdint> // uint64_t
+#include <functional> // function
+#include <istream>
+#include <string_view>
+#include <vector>
+
+#include "Graph.h"
+#include "Query.h"
+
+namespace granky {
+
+/**
+ * Feeds a graph from a .gky stream that may never end, such as stdin or a FIFO.
+ *
+ * A reader thread parses lines into batches of up to batchSize edges, and hands
+ * them over through a queue of at most capacity batches, so a slow graph holds
+ * the stream back rather than letting it pile up in memory. A batch is also
+ * handed over early whenever the stream has nothing more buffered, so that a
+ * quiet stream is not kept waiting for a batch to fill.
+ *
+ * The calling thread applies every batch, and runs the registered queries
+ * after every so many edges or so much time, whichever comes first, then
+ * reports the stream's Stats. Queries are initialised afresh every round,
+ * as the graph may have grown since the last one.
+ */
+class EdgeStream {
+
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Latency is from the first line of a batch being read to the batch being applied.
+     */
+    struct Stats {
+
+        uint64_t lines = 0;
+        uint64_t edges = 0;
+        uint64_t batches = 0;
+        uint64_t rounds = 0;
+        double seconds = 0.0;
+        double meanLatency = 0.0;
+        double maxLatency = 0.0;
+
+        double getEdgesPerSecond() const;
+    };
+
+    typedef std::function<void(const Stats&)> ReportCall;
+
+    static constexpr const size_t DEFAULT_BATCH_SIZE = 1024;
+    static constexpr const size_t DEFAULT_CAPACITY = 16;
+
+    explicit EdgeStream(Graph& graph, const size_t batchSize = DEFAULT_BATCH_SIZE, const size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * Queries are not owned, and run in the order they were added.
+     */
+    void addQuery(Query* query);
+
+    /**
+     * Zero turns either trigger off. Both default to off, leaving one round at the end.
+     */
+    void setInterval(const uint64_t edges, const std::chrono::milliseconds time);
+    void setReport(const ReportCall& report);
+
+    /**
+     * Reads the stream to its end, then runs a last round if anything changed
+     * since the one before. Returns the final Stats.
+     */
+    Stats run(std::istream& in);
+
+    /**
+     * Parses one .gky line into an edge, leaving to below zero for a line naming
+     * a lone node. Returns false for a line with no node on it.
+     */
+    static bool parseLine(std::string_view line, Graph::Edge& edge);
+
+private:
+    Graph& graph;
+    const size_t batchSize;
+    const size_t capacity;
+    std::vector<Query*> queries;
+    uint64_t everyEdges = 0;
+    std::chrono::milliseconds everyTime{0};
+    ReportCall report;
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_EDGESTREAM_H
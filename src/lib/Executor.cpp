@@ -0,0 +1,212 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm> // max
+#include <utility> // move
+
+#include "Executor.h"
+#include "Trace.h"
+
+namespace granky {
+
+namespace {
+
+// the executor and lane of the worker running on this thread, if any
+thread_local const Executor* currentExecutor = nullptr;
+thread_local unsigned currentLane = 0;
+
+} // namespace
+
+Executor::Executor(unsigned threads) {
+
+    if(!threads) {
+
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for(unsigned i = 0; i < threads; ++i) {
+
+        lanes.emplace_back(new Lane());
+    }
+
+    for(unsigned i = 0; i < threads; ++i) {
+
+        workers.emplace_back(&Executor::work, this, i);
+    }
+}
+
+Executor::~Executor() {
+
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for(auto& each : workers) {
+
+        each.join();
+    }
+}
+
+std::future<Query*> Executor::submit(Query& query, Graph& graph) {
+
+    return submit([&query, &graph]() {
+
+        query.init(&graph);
+        query.execute();
+        return &query;
+    });
+}
+
+void Executor::submit(Query& query, Graph& graph, const Completion& done) {
+
+    post([&query, &graph, done]() {
+
+        query.init(&graph);
+        query.execute();
+        done(query);
+    });
+}
+
+std::vector<std::future<Query*>> Executor::submit(const std::vector<Query*>& queries, Graph& graph) {
+
+    std::vector<std::future<Query*>> ret;
+    ret.reserve(queries.size());
+
+    for(const auto each : queries) {
+
+        ret.push_back(submit(*each, graph));
+    }
+
+    return ret;
+}
+
+void Executor::post(Task task) {
+
+    // a worker keeps what it submits, and anyone else's tasks are dealt out in turn
+    const auto index = currentExecutor == this ? currentLane : next++ % lanes.size();
+    auto& lane = *lanes[index];
+    ++unfinished;
+
+    // counted first, and under the mutex, so that a worker about to sleep sees it
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++queued;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        lane.tasks.push_back(std::move(task));
+    }
+
+    wake.notify_one();
+}
+
+bool Executor::take(const unsigned index, Task& task) {
+
+    {
+        auto& own = *lanes[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+
+        if(!own.tasks.empty()) {
+
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued;
+            return true;
+        }
+    }
+
+    for(size_t i = 1; i < lanes.size(); ++i) {
+
+        auto& other = *lanes[(index + i) % lanes.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+
+        if(!other.tasks.empty()) {
+
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            --queued;
+            ++steals;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Executor::work(const unsigned index) {
+
+    currentExecutor = this;
+    currentLane = index;
+    Task task;
+
+    for(;;) {
+
+        if(take(index, task)) {
+
+            {
+                GRANKY_TRACE("Executor::task");
+                task();
+            }
+
+            task = nullptr;
+
+            if(--unfinished == 0) {
+
+                std::lock_guard<std::mutex> lock(mutex);
+                idle.notify_all();
+            }
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this]() { return stopping || queued > 0; });
+
+        if(stopping && queued == 0) {
+
+            return;
+        }
+    }
+}
+
+void Executor::wait() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return unfinished == 0; });
+}
+
+unsigned Executor::getThreadCount() const {
+
+    return static_cast<unsigned>(workers.size());
+}
+
+uint64_t Executor::getStealCount() const {
+
+    return steals;
+}
+
+} // namespace granky
@@ -0,0 +1,144 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_EXECUTOR_H
+#define GRANKY_LIB_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint> // uint64_t
+#include <deque>
+#include <functional> // function
+#include <future>
+#include <memory> // unique_ptr, shared_ptr
+#include <mutex>
+#include <thread>
+#include <type_traits> // invoke_result, decay
+#include <vector>
+
+#include "Graph.h"
+#include "Query.h"
+
+namespace granky {
+
+/**
+ * A pool of worker threads that runs queries, and any other tasks, side by side.
+ *
+ * Every worker has a deque of tasks of its own. A worker takes its newest task
+ * first, while its oldest tasks are what idle workers steal, so a worker that
+ * submits tasks of its own keeps working on what is still in its cache. Tasks
+ * from other threads are dealt out to the workers in turn.
+ *
+ * Workers live as long as the executor, and so do the TablePools local to each
+ * of their threads: every query a worker runs borrows its tables from that
+ * worker's own pool, and no worker waits on another to allocate.
+ *
+ * Queries submitted together must each be a separate object, and the graph must
+ * not change until they finish. Queries that attach themselves to the graph as
+ * observers, such as ComponentTracker, must be initialised beforehand.
+ */
+class Executor {
+
+public:
+    typedef std::function<void()> Task;
+    typedef std::function<void(Query&)> Completion;
+
+    /**
+     * Threads defaults to the hardware concurrency.
+     */
+    explicit Executor(unsigned threads = 0);
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * Finishes every task already submitted before returning.
+     */
+    ~Executor();
+
+    /**
+     * Runs call on a worker, and returns a future of its result.
+     */
+    template<class CALL>
+    std::future<std::invoke_result_t<std::decay_t<CALL>>> submit(CALL&& call);
+
+    /**
+     * Initialises query on graph and executes it on a worker. The future holds
+     * the query once it has finished, or done is called with it on the worker.
+     */
+    std::future<Query*> submit(Query& query, Graph& graph);
+    void submit(Query& query, Graph& graph, const Completion& done);
+    std::vector<std::future<Query*>> submit(const std::vector<Query*>& queries, Graph& graph);
+
+    /**
+     * Runs a task on a worker, with nothing to wait on.
+     */
+    void post(Task task);
+
+    /**
+     * Waits until every task submitted so far, and every task they submit, has
+     * run. Tasks must not wait on the executor that runs them.
+     */
+    void wait();
+
+    unsigned getThreadCount() const;
+
+    /**
+     * The number of tasks a worker took from another's deque.
+     */
+    uint64_t getStealCount() const;
+
+private:
+    struct alignas(64) Lane {
+
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Lane>> lanes;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::atomic<uint64_t> queued{0};
+    std::atomic<uint64_t> unfinished{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<unsigned> next{0};
+    bool stopping = false;
+
+    void work(const unsigned index);
+    bool take(const unsigned index, Task& task);
+};
+
+template<class CALL>
+std::future<std::invoke_result_t<std::decay_t<CALL>>> Executor::submit(CALL&& call) {
+
+    typedef std::invoke_result_t<std::decay_t<CALL>> Result;
+
+    // a packaged task cannot be copied, and a Task must be
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<CALL>(call));
+    auto ret = task->get_future();
+    post([task]() { (*task)(); });
+    return ret;
+}
+
+} // namespace granky
+
+#endif // GRANKY_LIB_EXECUTOR_H
@@ -0,0 +1,379 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <math.h> // log, pow, floor
+#include <cassert>
+
+#include <algorithm> // upper_bound, min, max
+#include <charconv> // to_chars
+#include <string>
+#include <thread>
+#include <utility> // pair
+
+#include "Generator.h"
+
+namespace granky {
+
+static uint64_t mix(uint64_t value) {
+
+    // splitmix64 finaliser
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+static void format(std::string& out, const Generator::Chunk& chunk) {
+
+    // room for two nodes, the shortest round trip form of a double and separators
+    const size_t FIELD = 32;
+    char buffer[FIELD * 3 + 1];
+    out.clear();
+
+    for(const auto& each : chunk) {
+
+        auto end = std::to_chars(buffer, buffer + FIELD, each.from).ptr;
+        *end++ = ' ';
+        end = std::to_chars(end, end + FIELD, each.to).ptr;
+        *end++ = ' ';
+        end = std::to_chars(end, end + FIELD, each.weight).ptr;
+        *end++ = '\n';
+        out.append(buffer, end);
+    }
+}
+
+Generator::Generator(const Graph::Node end, const uint64_t chunks, const uint64_t s) :
+    endNode(end), chunkCount(chunks), seed(s) {
+
+    assert(end >= 0);
+}
+
+Graph::Node Generator::getEndNode() const {
+
+    return endNode;
+}
+
+uint64_t Generator::getChunkCount() const {
+
+    return chunkCount;
+}
+
+void Generator::setMaxWeight(const unsigned weight) {
+
+    maxWeight = weight;
+}
+
+Graph::Node Generator::generate(const Graph::EdgeCall& callback, unsigned threads) const {
+
+    Graph::Node ret = -1;
+
+    run<Chunk>(threads, [this](uint64_t chunk, Chunk& out) {
+
+        generateChunk(chunk, out);
+    }, [&callback, &ret](const Chunk& chunk) {
+
+        for(const auto& each : chunk) {
+
+            ret = callback(each.from, each.to, each.weight);
+
+            if(Graph::isNode(ret)) {
+
+                return false;
+            }
+        }
+
+        return true;
+    });
+
+    return ret;
+}
+
+void Generator::generate(Graph& graph, unsigned threads) const {
+
+    // a graph can only be added to from one thread at a time
+    run<Chunk>(threads, [this](uint64_t chunk, Chunk& out) {
+
+        generateChunk(chunk, out);
+    }, [&graph](const Chunk& chunk) {
+
+        for(const auto& each : chunk) {
+
+            graph.addEdge(each.from, each.to, each.weight);
+        }
+
+        return true;
+    });
+}
+
+void Generator::write(std::ostream& out, unsigned threads) const {
+
+    typedef std::pair<Chunk, std::string> Formatted;
+
+    run<Formatted>(threads, [this](uint64_t chunk, Formatted& result) {
+
+        generateChunk(chunk, result.first);
+        format(result.second, result.first);
+    }, [&out](const Formatted& result) {
+
+        out.write(result.second.data(), result.second.size());
+        return bool(out);
+    });
+}
+
+std::mt19937_64 Generator::getRandom(const uint64_t chunk) const {
+
+    return std::mt19937_64(mix(seed ^ mix(chunk)));
+}
+
+void Generator::emit(Chunk& out, std::mt19937_64& random, const Graph::Node from, const Graph::Node to) const {
+
+    if(from == to) {
+
+        return;
+    }
+
+    if(maxWeight > 1) {
+
+        out.push_back({from, to, Graph::Weight(1 + random() % maxWeight)});
+    }
+    else {
+
+        out.push_back({from, to, Graph::DEFAULT_DEFAULT_WEIGHT});
+    }
+}
+
+/**
+ * Generates chunks in rounds of one per thread, then hands them to consume in
+ * order. Stops after the round in which consume returns false.
+ */
+template<class RESULT, class WORK, class CONSUME>
+void Generator::run(unsigned threads, const WORK& work, const CONSUME& consume) const {
+
+    if(threads == 0) {
+
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    threads = std::max<uint64_t>(1, std::min<uint64_t>(threads, chunkCount));
+    std::vector<RESULT> results(threads);
+
+    for(uint64_t first = 0; first < chunkCount; first += threads) {
+
+        const auto count = std::min<uint64_t>(threads, chunkCount - first);
+        std::vector<std::thread> workers;
+
+        for(uint64_t i = 1; i < count; ++i) {
+
+            workers.emplace_back([&work, &results, first, i]() {
+
+                work(first + i, results[i]);
+            });
+        }
+
+        work(first, results[0]);
+
+        for(auto& each : workers) {
+
+            each.join();
+        }
+
+        for(uint64_t i = 0; i < count; ++i) {
+
+            if(!consume(results[i])) {
+
+                return;
+            }
+        }
+    }
+}
+
+RMatGenerator::RMatGenerator(const unsigned s, const unsigned edgeFactor, const uint64_t seed,
+        const double a, const double b, const double c) :
+    Generator(Graph::Node(1) << s, ((uint64_t(edgeFactor) << s) + CHUNK_EDGES - 1) / CHUNK_EDGES, seed),
+    scale(s), edges(uint64_t(edgeFactor) << s), a(a), b(b), c(c) {
+
+    assert(s < 31 && a + b + c <= 1.0);
+}
+
+void RMatGenerator::generateChunk(const uint64_t chunk, Chunk& out) const {
+
+    auto random = getRandom(chunk);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const auto first = chunk * CHUNK_EDGES;
+    const auto last = std::min(edges, first + CHUNK_EDGES);
+
+    out.clear();
+    out.reserve(last - first);
+
+    for(auto i = first; i < last; ++i) {
+
+        Graph::Node from = 0;
+        Graph::Node to = 0;
+
+        for(unsigned level = 0; level < scale; ++level) {
+
+            const auto roll = uniform(random);
+            const Graph::Node down = roll >= a + b;
+            const Graph::Node right = (roll >= a && roll < a + b) || roll >= a + b + c;
+            from = (from << 1) | down;
+            to = (to << 1) | right;
+        }
+
+        emit(out, random, from, to);
+    }
+}
+
+static Graph::Node rowsFor(const double rowEdges, const Graph::Node rows) {
+
+    const auto ret = rowEdges > 0 ? double(Generator::CHUNK_EDGES) / rowEdges : double(rows);
+    return Graph::Node(std::max(1.0, std::min(ret, double(std::max<Graph::Node>(rows, 1)))));
+}
+
+ErdosRenyiGenerator::ErdosRenyiGenerator(const Graph::Node n, const double probability, const uint64_t seed) :
+    Generator(n, (n + rowsFor(probability * n, n) - 1) / rowsFor(probability * n, n), seed),
+    nodes(n), p(probability), rowsPerChunk(rowsFor(probability * n, n)) {
+
+    assert(p >= 0.0 && p <= 1.0);
+}
+
+void ErdosRenyiGenerator::generateChunk(const uint64_t chunk, Chunk& out) const {
+
+    auto random = getRandom(chunk);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const Graph::Node firstRow = chunk * rowsPerChunk;
+    const Graph::Node lastRow = std::min<Graph::Node>(nodes, firstRow + rowsPerChunk);
+
+    out.clear();
+
+    if(p <= 0.0 || nodes < 2) {
+
+        return;
+    }
+
+    // each row has nodes - 1 candidate heads, skipping the diagonal
+    const uint64_t width = nodes - 1;
+    const uint64_t end = uint64_t(lastRow - firstRow) * width;
+    const auto scale = p < 1.0 ? 1.0 / log(1.0 - p) : 0.0;
+    out.reserve(size_t(p * end) + 16);
+
+    for(uint64_t at = 0;; ++at) {
+
+        if(p < 1.0) {
+
+            const auto skip = floor(log(1.0 - uniform(random)) * scale);
+
+            if(skip >= double(end - at)) {
+
+                break;
+            }
+
+            at += uint64_t(skip);
+        }
+
+        if(at >= end) {
+
+            break;
+        }
+
+        const Graph::Node from = firstRow + Graph::Node(at / width);
+        Graph::Node to = Graph::Node(at % width);
+        to += to >= from;
+        emit(out, random, from, to);
+    }
+}
+
+GridGenerator::GridGenerator(const Graph::Node r, const Graph::Node c, const uint64_t seed) :
+    Generator(r * c, (r + rowsFor(4.0 * c, r) - 1) / rowsFor(4.0 * c, r), seed),
+    rows(r), columns(c), rowsPerChunk(rowsFor(4.0 * c, r)) {
+
+    assert(r >= 0 && c >= 0);
+}
+
+void GridGenerator::generateChunk(const uint64_t chunk, Chunk& out) const {
+
+    auto random = getRandom(chunk);
+    const Graph::Node firstRow = chunk * rowsPerChunk;
+    const Graph::Node lastRow = std::min(rows, firstRow + rowsPerChunk);
+
+    out.clear();
+    out.reserve(size_t(lastRow - firstRow) * columns * 4);
+
+    for(auto row = firstRow; row < lastRow; ++row) {
+
+        for(Graph::Node column = 0; column < columns; ++column) {
+
+            const auto node = row * columns + column;
+
+            if(column + 1 < columns) {
+
+                emit(out, random, node, node + 1);
+                emit(out, random, node + 1, node);
+            }
+
+            if(row + 1 < rows) {
+
+                emit(out, random, node, node + columns);
+                emit(out, random, node + columns, node);
+            }
+        }
+    }
+}
+
+ChungLuGenerator::ChungLuGenerator(const Graph::Node n, const double degree, const double exponent, const uint64_t seed) :
+    Generator(n, (uint64_t(degree * n) + CHUNK_EDGES - 1) / CHUNK_EDGES, seed),
+    edges(uint64_t(degree * n)), cumulative(n) {
+
+    assert(n > 0 && degree >= 0.0 && exponent > 1.0);
+
+    const auto power = -1.0 / (exponent - 1.0);
+    double total = 0.0;
+
+    for(Graph::Node each = 0; each < n; ++each) {
+
+        total += pow(each + 1.0, power);
+        cumulative[each] = total;
+    }
+}
+
+void ChungLuGenerator::generateChunk(const uint64_t chunk, Chunk& out) const {
+
+    auto random = getRandom(chunk);
+    const auto first = chunk * CHUNK_EDGES;
+    const auto last = std::min(edges, first + CHUNK_EDGES);
+
+    out.clear();
+    out.reserve(last - first);
+
+    for(auto i = first; i < last; ++i) {
+
+        const auto from = pick(random);
+        emit(out, random, from, pick(random));
+    }
+}
+
+Graph::Node ChungLuGenerator::pick(std::mt19937_64& random) const {
+
+    std::uniform_real_distribution<double> uniform(0.0, cumulative.back());
+    const auto found = std::upper_bound(cumulative.begin(), cumulative.end(), uniform(random));
+    return Graph::Node(std::min<size_t>(found - cumulative.begin(), cumulative.size() - 1));
+}
+
+} // namespace granky
@@ -0,0 +1,178 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_GENERATOR_H
+#define GRANKY_LIB_GENERATOR_H
+
+#include <cstdint> // uint64_t
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * Synthetic graph generators.
+ *
+ * A generator splits its output into chunks, each generated from its own
+ * random stream derived from the seed and the chunk number. The output is
+ * therefore the same for a given seed however many threads are used:
+ * threads generate chunks side by side, and the chunks are delivered in
+ * order. Nothing larger than one chunk per thread is ever held in memory.
+ *
+ * Generators never produce self loops. Weights are DEFAULT_DEFAULT_WEIGHT,
+ * unless setMaxWeight asks for whole random weights from 1 to that maximum.
+ */
+class Generator {
+
+public:
+    typedef Graph::EdgeList Chunk;
+
+    /**
+     * The number of edges a chunk aims for.
+     */
+    static constexpr const uint64_t CHUNK_EDGES = 1 << 20;
+
+    virtual ~Generator() = default;
+
+    Graph::Node getEndNode() const;
+    uint64_t getChunkCount() const;
+    void setMaxWeight(const unsigned weight);
+
+    /**
+     * Generates one chunk, replacing the contents of out.
+     */
+    virtual void generateChunk(const uint64_t chunk, Chunk& out) const = 0;
+
+    /**
+     * Calls back once per edge, in order, on the calling thread only. Threads
+     * defaults to the hardware concurrency. Stops early, returning the callback's
+     * result, when the callback returns a node; otherwise returns -1.
+     */
+    Graph::Node generate(const Graph::EdgeCall& callback, unsigned threads = 0) const;
+
+    /**
+     * Adds every edge straight to a graph, without an intermediate file.
+     */
+    void generate(Graph& graph, unsigned threads = 0) const;
+
+    /**
+     * Writes every edge in .gky format. Formatting happens on the worker threads.
+     */
+    void write(std::ostream& out, unsigned threads = 0) const;
+
+protected:
+    Generator(const Graph::Node end, const uint64_t chunks, const uint64_t seed);
+
+    /**
+     * The random stream of a chunk.
+     */
+    std::mt19937_64 getRandom(const uint64_t chunk) const;
+
+    void emit(Chunk& out, std::mt19937_64& random, const Graph::Node from, const Graph::Node to) const;
+
+private:
+    const Graph::Node endNode;
+    const uint64_t chunkCount;
+    const uint64_t seed;
+    unsigned maxWeight = 0;
+
+    template<class RESULT, class WORK, class CONSUME>
+    void run(unsigned threads, const WORK& work, const CONSUME& consume) const;
+};
+
+/**
+ * Recursive matrix (R-MAT) graphs, the Kronecker graphs of the Graph500 benchmark.
+ * 2^scale nodes and edgeFactor * 2^scale edges before duplicates and self loops are dropped.
+ * Every edge descends scale levels into one quadrant of the adjacency matrix,
+ * chosen with probabilities a, b, c and 1 - a - b - c.
+ */
+class RMatGenerator : public Generator {
+
+public:
+    RMatGenerator(const unsigned scale, const unsigned edgeFactor, const uint64_t seed,
+            const double a = 0.57, const double b = 0.19, const double c = 0.19);
+    virtual void generateChunk(const uint64_t chunk, Chunk& out) const override;
+
+private:
+    const unsigned scale;
+    const uint64_t edges;
+    const double a;
+    const double b;
+    const double c;
+};
+
+/**
+ * Erdős–Rényi G(n, p) graphs: every directed pair of distinct nodes is an edge
+ * with probability p. Gaps between edges are drawn from the geometric distribution,
+ * so generation costs time in the number of edges rather than pairs.
+ */
+class ErdosRenyiGenerator : public Generator {
+
+public:
+    ErdosRenyiGenerator(const Graph::Node nodes, const double p, const uint64_t seed);
+    virtual void generateChunk(const uint64_t chunk, Chunk& out) const override;
+
+private:
+    const Graph::Node nodes;
+    const double p;
+    const Graph::Node rowsPerChunk;
+};
+
+/**
+ * Two dimensional grids, with an edge each way between horizontal and vertical neighbours.
+ * The node in a given row and column is row * columns + column.
+ */
+class GridGenerator : public Generator {
+
+public:
+    GridGenerator(const Graph::Node rows, const Graph::Node columns, const uint64_t seed = 0);
+    virtual void generateChunk(const uint64_t chunk, Chunk& out) const override;
+
+private:
+    const Graph::Node rows;
+    const Graph::Node columns;
+    const Graph::Node rowsPerChunk;
+};
+
+/**
+ * Chung-Lu graphs with a power-law degree distribution. Node i has expected
+ * degree proportional to (i + 1) ^ (-1 / (exponent - 1)), scaled so that the
+ * average degree is as given, and both ends of every edge are drawn by degree.
+ */
+class ChungLuGenerator : public Generator {
+
+public:
+    ChungLuGenerator(const Graph::Node nodes, const double degree, const double exponent, const uint64_t seed);
+    virtual void generateChunk(const uint64_t chunk, Chunk& out) const override;
+
+private:
+    const uint64_t edges;
+    std::vector<double> cumulative;
+
+    Graph::Node pick(std::mt19937_64& random) const;
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_GENERATOR_H
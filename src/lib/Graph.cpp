@@ -24,11 +24,207 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <cstring> // memcpy
+#include <algorithm> // remove
+#include <atomic>
+#include <thread>
 
 #include "Graph.h"
+#include "TablePool.h"
+#include "Trace.h"
 
 namespace granky {
 
+static std::atomic<Graph::Version> nextVersion(1);
+
+/**
+ * splitmix64 finaliser
+ */
+static inline uint64_t mix(uint64_t x) {
+
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t Graph::hashEdge(const Node from, const Node to, const Weight weight) {
+
+    // 0.0 and -0.0 compare equal, so they must hash equal
+    const Graph::Weight normal = weight == 0 ? 0.0 : weight;
+    uint64_t bits = 0;
+    memcpy(&bits, &normal, std::min(sizeof(bits), sizeof(normal)));
+    return mix(mix(mix(static_cast<uint64_t>(from)) ^ static_cast<uint64_t>(to)) ^ bits);
+}
+
+Graph::Graph() : version(nextVersion++) {}
+
+Graph::Version Graph::getVersion() const {
+
+    return version;
+}
+
+uint64_t Graph::getFingerprint() const {
+
+    return fingerprint;
+}
+
+size_t Graph::getEdgeCount() const {
+
+    return edgeCount;
+}
+
+Graph::EdgeDiff Graph::diff(const Graph& before, const Graph& after, unsigned threads) {
+
+    if(!threads) {
+
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const auto end = std::max(before.getEndNode(), after.getEndNode());
+    const auto chunk = (end + threads - 1) / threads;
+    std::vector<EdgeDiff> parts(threads);
+    std::vector<std::thread> workers;
+
+    const auto work = [&before, &after](EdgeDiff& part, const Node first, const Node last) {
+
+        for(Node from = first; from < last; ++from) {
+
+            const ProgressCall afterCall = [&](Node to, Weight weight) {
+
+                if(from == to) {
+
+                    return -1;
+                }
+
+                if(const auto old = before.getWeight(from, to); !isWeight(old)) {
+
+                    part.added.push_back({from, to, weight});
+                }
+                else if(old != weight) {
+
+                    part.reweighted.push_back({from, to, weight});
+                }
+
+                return -1;
+            };
+
+            const ProgressCall beforeCall = [&](Node to, Weight weight) {
+
+                if(from != to && !after.haveEdge(from, to)) {
+
+                    part.removed.push_back({from, to, weight});
+                }
+
+                return -1;
+            };
+
+            after.forEachEgress(from, afterCall);
+            before.forEachEgress(from, beforeCall);
+        }
+    };
+
+    for(unsigned i = 0; i < threads; ++i) {
+
+        const Node first = std::min<Node>(end, i * chunk);
+        const Node last = std::min<Node>(end, first + chunk);
+        workers.emplace_back(work, std::ref(parts[i]), first, last);
+    }
+
+    EdgeDiff ret;
+    size_t added = 0;
+    size_t removed = 0;
+    size_t reweighted = 0;
+
+    for(unsigned i = 0; i < threads; ++i) {
+
+        workers[i].join();
+        added += parts[i].added.size();
+        removed += parts[i].removed.size();
+        reweighted += parts[i].reweighted.size();
+    }
+
+    ret.added.reserve(added);
+    ret.removed.reserve(removed);
+    ret.reweighted.reserve(reweighted);
+
+    for(const auto& part : parts) {
+
+        ret.added.insert(ret.added.end(), part.added.begin(), part.added.end());
+        ret.removed.insert(ret.removed.end(), part.removed.begin(), part.removed.end());
+        ret.reweighted.insert(ret.reweighted.end(), part.reweighted.begin(), part.reweighted.end());
+    }
+
+    return ret;
+}
+
+void Graph::attach(Observer* observer) {
+
+    assert(observer);
+    observers.push_back(observer);
+}
+
+void Graph::detach(Observer* observer) {
+
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void Graph::noteNode(const Node node) {
+
+    version = nextVersion++;
+    notifyNode(node);
+}
+
+void Graph::copyState(const Graph& other) {
+
+    version = other.getVersion();
+    fingerprint = other.getFingerprint();
+    edgeCount = other.getEdgeCount();
+}
+
+void Graph::notifyNode(const Node node) const {
+
+    for(const auto each : observers) {
+
+        each->onNode(node);
+    }
+}
+
+void Graph::notifyEdge(const Node from, const Node to, const Weight previous, const Weight weight) const {
+
+    for(const auto each : observers) {
+
+        each->onEdge(from, to, previous, weight);
+    }
+}
+
+Graph::Version Graph::drawVersion() {
+
+    return nextVersion++;
+}
+
+void Graph::noteEdge(const Node from, const Node to, const Weight previous, const Weight weight) {
+
+    version = nextVersion++;
+
+    // the fingerprint is a sum, so an edge can be taken out again when it changes
+    if(from != to) {
+
+        if(isWeight(previous)) {
+
+            fingerprint -= hashEdge(from, to, previous);
+        }
+        else {
+
+            ++edgeCount;
+        }
+
+        fingerprint += hashEdge(from, to, weight);
+    }
+
+    notifyEdge(from, to, previous, weight);
+}
+
 bool Graph::haveEdge(const Node from, const Node to) const {
     
     return isWeight(getWeight(from, to));
@@ -56,7 +252,7 @@ Graph::Weight Graph::getLightDigress(const Node from, const Node to) const {
     const auto in = getWeight(to, from);
     const auto isEx = isWeight(ex);
     const auto isIn = isWeight(in);
-    return isEx && isIn ? std::min(ex, in) : isEx ? ex : isIn ? in : NAN;
+    return isEx && isIn ? std::min(ex, in) : isEx ? ex : isIn ? in : NO_WEIGHT;
 }
 
 Graph::Node Graph::forEachEdge(const EdgeCall& edgeCall) const {
@@ -74,9 +270,39 @@ Graph::Node Graph::forEachEdge(const EdgeCall& edgeCall) const {
     return forEachNode(nodeCall);
 }
 
+Graph::Node Graph::forEachEdgeBlock(const BlockCall& blockCall, const size_t blockSize) const {
+
+    assert(blockSize > 0);
+
+    EdgeList block;
+    block.reserve(std::min(blockSize, getEdgeCount() + 1));
+    Node ret = -1;
+
+    const EdgeCall edgeCall = [&](Node from, Node to, Weight weight) -> Node {
+
+        block.push_back({from, to, weight});
+
+        if(block.size() < blockSize) {
+
+            return -1;
+        }
+
+        ret = blockCall(block);
+        block.clear();
+        return ret;
+    };
+
+    if(isNode(forEachEdge(edgeCall))) {
+
+        return ret;
+    }
+
+    return block.empty() ? ret : blockCall(block);
+}
+
 bool Graph::isSubset(const Graph& other) const {
 
-    const EdgeCall edgeCall = [&other](Node from, Node to, Weight weight) {
+    const EdgeCall edgeCall = [&other](Node from, Node to, Weight weight) -> Node {
 
         if(other.haveEdge(from, to, weight)) {
 
@@ -97,12 +323,14 @@ void Graph::addDoubleEdge(const Node from, const Node to, const Weight weight) {
 
 Graph::Table::Instance Graph::getBlankNodeCheck() {
 
-    return move(Table::create<NodeCheck>(getEndNode()));
+    GRANKY_TRACE("Graph::getBlankNodeCheck");
+    return TablePool::local().borrow(getEndNode());
 }
 
 Graph::Table::Instance Graph::getBlankNodeTally() {
 
-    return move(Table::create<NodeTally>(getEndNode()));
+    GRANKY_TRACE("Graph::getBlankNodeTally");
+    return TablePool::local().borrow(getEndNode());
 }
 
 Graph::Table::Instance Graph::getNodeCheck() {
@@ -135,6 +363,11 @@ void Graph::parseString(std::string_view str) {
 
 bool operator == (const Graph& left, const Graph& right) {
 
+    if(left.getEdgeCount() != right.getEdgeCount() || left.getFingerprint() != right.getFingerprint()) {
+
+        return false;
+    }
+
     return left.isSubset(right) && right.isSubset(left);
 }
 
@@ -159,6 +392,8 @@ std::ostream& operator << (std::ostream& out, const Graph& graph) {
 
 std::istream& operator >> (std::istream& in, Graph& graph) {
 
+    GRANKY_TRACE("Graph::parse");
+
     const auto endEdge = [&in]() {
 
         return in.peek() == '\n' || in.eof();
@@ -209,6 +444,16 @@ std::istream& operator >> (std::istream& in, Graph& graph) {
     return in;
 }
 
+void Graph::Table::Release::operator()(Table* table) const {
+
+    table->release();
+}
+
+void Graph::Table::release() {
+
+    delete this;
+}
+
 Graph::Node Graph::NodeCheck::get(const Node node) const {
 
     assert(Graph::isNode(node) && node < table.size());
@@ -221,6 +466,11 @@ void Graph::NodeCheck::set(const Node node, const Node value) {
     table[node] = Graph::isNode(value);
 };
 
+Graph::Table::Instance Graph::NodeCheck::clone() const {
+
+    return Table::Instance(new(std::nothrow) NodeCheck(*this));
+}
+
 Graph::Node Graph::NodeTally::get(const Node node) const {
 
     assert(Graph::isNode(node) && node < table.size());
@@ -233,4 +483,9 @@ void Graph::NodeTally::set(const Node node, const Node value) {
     table[node] = value;
 };
 
+Graph::Table::Instance Graph::NodeTally::clone() const {
+
+    return Table::Instance(new(std::nothrow) NodeTally(*this));
+}
+
 } // namespace granky
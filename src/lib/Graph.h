@@ -24,11 +24,29 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <math.h> // isnan
 
-#include <forward_list>
+#include <cstdint> // uint64_t
+#include <limits> // numeric_limits
 #include <memory> // unique_ptr
 #include <ostream>
 #include <istream>
 #include <functional> // fuction
+#include <type_traits> // is_signed
+#include <vector>
+
+/**
+ * The node and weight types are chosen when the library is compiled, by
+ * defining GRANKY_NODE as a signed integer type and GRANKY_WEIGHT as a
+ * floating point or signed integer type of at least 32 bits, since path
+ * lengths are summed in the weight type. Every translation unit must agree.
+ * A float or int32_t weight halves the size of every edge a backend keeps.
+ */
+#ifndef GRANKY_NODE
+#define GRANKY_NODE int
+#endif
+
+#ifndef GRANKY_WEIGHT
+#define GRANKY_WEIGHT double
+#endif
 
 /**
  * LEXICON
@@ -38,7 +56,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
  * Leaf: an empty or nonexistent node, represented by giving a node a value below zero.
  * Edge: a weighted, directed connection between two nodes.
  * * There may be at most one edge in a given direction between a given pair of nodes.
- * * An empty or nonexistent edge has a value of NAN.
+ * * An empty or nonexistent edge has a value of NO_WEIGHT, which is NAN for floating point weights.
  * Egress (from x to y): an edge leading from node x to node y.
  * Ingress (from x to y): an edge leading to node x from node y.
  * Progress: in a given context, either all ingresses or all egresses are considered progresses.
@@ -52,16 +70,33 @@ namespace granky {
 
 class Graph {
 
+    static_assert(std::is_signed<GRANKY_NODE>::value && std::is_integral<GRANKY_NODE>::value, "nodes below zero are leaves");
+    static_assert(std::is_signed<GRANKY_WEIGHT>::value, "weights may be negative");
+    static_assert(std::is_floating_point<GRANKY_WEIGHT>::value || sizeof(GRANKY_WEIGHT) >= 4, "integral weights narrower than 32 bits overflow");
+
 public:
-    typedef int Node;
+    typedef GRANKY_NODE Node;
 
     class Table {
 
     public:
-        typedef std::unique_ptr<Table> Instance;
+        /**
+         * Disposes of a table through release, so that pooled tables go back to their pool.
+         */
+        struct Release {
+
+            void operator()(Table* table) const;
+        };
+
+        typedef std::unique_ptr<Table, Release> Instance;
+        virtual ~Table() = default;
         virtual Node get(const Node node) const = 0;
         virtual void set(const Node node, const Node value) = 0;
+        virtual Instance clone() const = 0;
         template<class TABLE_TYPE> static Instance create(const Node count);
+
+    protected:
+        virtual void release();
     };
 
     class NodeCheck : public Table {
@@ -72,6 +107,7 @@ public:
         NodeCheck(const Node count) : table(count, 0) {};
         virtual Node get(const Node node) const;
         virtual void set(const Node node, const Node value);
+        virtual Instance clone() const;
     };
 
     class NodeTally : public Table {
@@ -82,9 +118,11 @@ public:
         NodeTally(const Node count) : table(count, -1) {};
         virtual Node get(const Node node) const;
         virtual void set(const Node node, const Node value);
+        virtual Instance clone() const;
     };
 
-    typedef double Weight;
+    typedef GRANKY_WEIGHT Weight;
+    typedef uint64_t Version;
     typedef std::unique_ptr<Graph> Instance;
     typedef std::function<Node(Node)> NodeCall;
     typedef std::function<Node(Node, Weight)> ProgressCall;
@@ -92,12 +130,38 @@ public:
 
     struct Edge {
         
-        const Node from;
-        const Node to;
-        const Weight weight;
+        Node from;
+        Node to;
+        Weight weight;
+    };
+
+    /**
+     * Edges are kept contiguously, so that a list of any length costs a few large allocations.
+     */
+    typedef std::vector<Edge> EdgeList;
+    typedef std::function<Node(const EdgeList&)> BlockCall;
+
+    /**
+     * The edges that differ between two graphs. Reweighted edges carry their new weight.
+     */
+    struct EdgeDiff {
+
+        EdgeList added;
+        EdgeList removed;
+        EdgeList reweighted;
     };
 
-    typedef std::forward_list<Edge> EdgeList;
+    /**
+     * Receives every change made to a graph it is attached to, after the change is made.
+     * onEdge is given the weight the edge had before, which is NO_WEIGHT for a new edge.
+     */
+    class Observer {
+
+    public:
+        virtual ~Observer() = default;
+        virtual void onNode(const Node /*node*/) {}
+        virtual void onEdge(const Node /*from*/, const Node /*to*/, const Weight /*previous*/, const Weight /*weight*/) {}
+    };
 
     void parseFile(std::string_view filename);
     void parseString(std::string_view str);
@@ -109,7 +173,7 @@ public:
 
     virtual bool haveNode(const Node node) const = 0;
     virtual Weight getWeight(const Node from, const Node to) const = 0;
-    virtual const EdgeList getEdges() const = 0;
+    virtual EdgeList getEdges() const = 0;
     virtual void addNode(const Node node) = 0;
     virtual void addEdge(const Node from, const Node to, const Weight weight) = 0;
     virtual Node getNodeCount() const = 0;
@@ -131,26 +195,117 @@ public:
     
     static inline bool isWeight(const Weight weight) {
         
-        return !isnan(weight);
+        if constexpr(std::numeric_limits<Weight>::has_quiet_NaN) {
+
+            return !isnan(weight);
+        }
+        else {
+
+            return weight != NO_WEIGHT;
+        }
     };
     
+    /**
+     * Every change to a graph moves it to a new version, drawn from one
+     * counter shared by all graphs, so no change ever reuses a version. Copies
+     * of a graph's state, such as a snapshot or a CompressedGraph, keep its
+     * version, so graphs share a version only when their content is identical.
+     */
+    virtual Version getVersion() const;
+
+    /**
+     * An order-independent hash of every edge and its weight, kept up to date by
+     * addEdge. Equal graphs always have equal fingerprints. Self loops are left
+     * out, as MatrixGraph keeps its nodes on the diagonal and never reports them.
+     */
+    virtual uint64_t getFingerprint() const;
+
+    /**
+     * The number of edges, self loops excepted.
+     */
+    virtual size_t getEdgeCount() const;
+
+    /**
+     * Compares two graphs edge by edge, splitting the node range between threads.
+     * Both graphs must not change while the diff runs.
+     */
+    static EdgeDiff diff(const Graph& before, const Graph& after, unsigned threads = 0);
+
+    /**
+     * Observers are not owned by the graph, and must detach before they are destroyed.
+     */
+    void attach(Observer* observer);
+    void detach(Observer* observer);
+
     bool haveEdge(const Node from, const Node to) const;
     bool haveEdge(const Node from, const Node to, const Weight weight) const; 
     bool haveDigress(const Node from, const Node to) const;
     Weight getLightDigress(const Node from, const Node to) const;
     Node forEachEdge(const EdgeCall& edgeCall) const; 
+
+    /**
+     * Streams every edge through one reused buffer, calling back each time it
+     * holds blockSize edges and once more for the rest. Stops as forEach does.
+     */
+    Node forEachEdgeBlock(const BlockCall& blockCall, const size_t blockSize = DEFAULT_BLOCK_SIZE) const;
     bool isSubset(const Graph& other) const; 
     void addDoubleEdge(const Node from, const Node to, const Weight weight); 
-    Table::Instance getBlankNodeCheck(); 
     Table::Instance getNodeCheck(); 
+
+    /**
+     * Blank tables are borrowed from the calling thread's TablePool, and go back when destroyed.
+     */
+    Table::Instance getBlankNodeCheck(); 
     Table::Instance getBlankNodeTally();
 
     friend std::ostream& operator << (std::ostream& out, const Graph& g);
     friend std::istream& operator >> (std::istream& in, Graph& g);
 
-    static constexpr const double DEFAULT_DEFAULT_WEIGHT = 1.0;
+    static constexpr const Weight DEFAULT_DEFAULT_WEIGHT = 1;
+
+    /**
+     * NO_WEIGHT marks a missing edge or an unknown distance: NAN where the weight
+     * type has it, or else the lowest value. MAX_WEIGHT stands for an unreachable
+     * distance: infinity where the weight type has it, or else the highest value.
+     */
+    static constexpr const Weight NO_WEIGHT = std::numeric_limits<Weight>::has_quiet_NaN ?
+            std::numeric_limits<Weight>::quiet_NaN() : std::numeric_limits<Weight>::lowest();
+    static constexpr const Weight MAX_WEIGHT = std::numeric_limits<Weight>::has_infinity ?
+            std::numeric_limits<Weight>::infinity() : std::numeric_limits<Weight>::max();
+    static constexpr const size_t DEFAULT_BLOCK_SIZE = 1 << 16;
+
+    virtual ~Graph() = default;
 
 protected:
+    Graph();
+
+    /**
+     * Backends call noteNode when addNode adds a node, and noteEdge whenever
+     * addEdge is called, so that the version advances and observers hear of it.
+     */
+    void noteNode(const Node node);
+    void noteEdge(const Node from, const Node to, const Weight previous, const Weight weight);
+
+    /**
+     * Takes on the version, fingerprint and edge count of another graph,
+     * for backends that stand in for another graph as it was at one moment.
+     */
+    void copyState(const Graph& other);
+
+    /**
+     * For backends that keep their own version, fingerprint and edge count, and
+     * so only need noteNode and noteEdge to tell observers.
+     */
+    void notifyNode(const Node node) const;
+    void notifyEdge(const Node from, const Node to, const Weight previous, const Weight weight) const;
+    static Version drawVersion();
+    static uint64_t hashEdge(const Node from, const Node to, const Weight weight);
+
+private:
+    Version version;
+    uint64_t fingerprint = 0;
+    size_t edgeCount = 0;
+    std::vector<Observer*> observers;
 };
 
 template<class TABLE_TYPE>
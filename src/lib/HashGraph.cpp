@@ -63,26 +63,23 @@ Graph::Node HashGraph::forEachEgress(const Node from, const ProgressCall& callba
 
 Graph::Node HashGraph::forEachIngress(const Node to, const ProgressCall& callback) const {
 
-    if(!haveNode(to)) {
+    const auto adjacent = ingress.find(to);
+
+    if(adjacent == ingress.end()) {
 
         return -1;
     }
 
     Node ret = -1;
 
-    for(const auto& each : graph) {
+    for(const auto& each : adjacent->second) {
 
         const auto& from = each.first;
-        const auto& adjacent = each.second;
-
-        if(const auto got = adjacent.find(to); got != adjacent.end()) {
-
-            const auto& weight = got->second;
+        const auto& weight = each.second;
 
-            if(ret = callback(from, weight); isNode(ret)) {
+        if(ret = callback(from, weight); isNode(ret)) {
 
-                return ret;
-            }
+            return ret;
         }
     }
 
@@ -97,8 +94,9 @@ Graph::Node HashGraph::forEachLightDigress(const Node from, const ProgressCall&
     }
 
     Node ret = -1;
+    const auto& exits = graph.at(from);
 
-    for(auto& each : graph.at(from)) {
+    for(auto& each : exits) {
 
         const auto& to = each.first;
         const auto weight = getLightDigress(from, to);
@@ -109,22 +107,47 @@ Graph::Node HashGraph::forEachLightDigress(const Node from, const ProgressCall&
         }
     }
 
+    const auto entries = ingress.find(from);
+
+    if(entries == ingress.end()) {
+
+        return ret;
+    }
+
+    // ingresses from nodes that are also egresses were already covered above
+    for(auto& each : entries->second) {
+
+        const auto& to = each.first;
+        const auto& weight = each.second;
+
+        if(exits.find(to) != exits.end()) {
+
+            continue;
+        }
+
+        if(ret = callback(to, weight); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
     return ret;
 }
 
-const Graph::EdgeList HashGraph::getEdges() const {
+Graph::EdgeList HashGraph::getEdges() const {
 
     EdgeList ret;
+    ret.reserve(getEdgeCount());
 
     for(const auto& each : graph) {
     
         for(const auto& other : each.second) {
 
-            ret.push_front({each.first, other.first, other.second});
+            ret.push_back({each.first, other.first, other.second});
         }
     }
     
-    return move(ret);
+    return ret;
 }
 
 bool HashGraph::haveNode(const Node node) const {
@@ -136,7 +159,7 @@ Graph::Weight HashGraph::getWeight(const Node from, const Node to) const {
 
     if(!haveNode(from)) {
 
-        return NAN;
+        return NO_WEIGHT;
     }
 
     const auto& exits = graph.at(from);
@@ -146,7 +169,7 @@ Graph::Weight HashGraph::getWeight(const Node from, const Node to) const {
         return exits.at(to);
     }
 
-    return NAN;
+    return NO_WEIGHT;
 }
 
 void HashGraph::addNode(const Node node) {
@@ -155,6 +178,7 @@ void HashGraph::addNode(const Node node) {
 
         graph[node] = {};
         endNode = std::max(endNode, node + 1);
+        noteNode(node);
     }
 }
 
@@ -162,7 +186,11 @@ void HashGraph::addEdge(const Node from, const Node to, const Weight weight) {
 
     addNode(from);
     addNode(to);
+
+    const auto previous = getWeight(from, to);
     graph[from][to] = weight;
+    ingress[to][from] = weight;
+    noteEdge(from, to, previous, weight);
 }
 
 Graph::Node HashGraph::getNodeCount() const {
@@ -39,7 +39,7 @@ public:
     HashGraph& operator=(const HashGraph&&) = delete;
     explicit HashGraph() {};
  
-    virtual const EdgeList getEdges() const override;
+    virtual EdgeList getEdges() const override;
     virtual bool haveNode(const Node node) const override;
     virtual Weight getWeight(const Node from, const Node to) const override;
     virtual void addNode(const Node node) override;
@@ -55,6 +55,7 @@ public:
 private:
     typedef std::unordered_map<Node, std::unordered_map<Node, Weight>> HashTable;
     HashTable graph;
+    HashTable ingress;
     Node endNode = 0;
 };
 
@@ -21,10 +21,11 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <cassert>
 #include <math.h> // isnan
-#include <iostream> // cout, endl
 
 #include "MatrixGraph.h"
+#include "Trace.h"
 
+// VERBOSE records every added edge as an instant in the Trace
 #ifndef VERBOSE
 #define VERBOSE 0
 #endif
@@ -56,15 +57,16 @@ Graph::Node MatrixGraph::forEachEgress(const Node from, const ProgressCall& call
     }
 
     Node ret = -1;
+    const auto& row = graph[from];
     
-    for(Node to = 0; !isNode(ret) && to < graph.size(); ++to) {
+    for(Node to = 0; !isNode(ret) && to < row.size(); ++to) {
 
         if(from == to) {
 
             continue;
         }
 
-        if(const auto weight = getWeight(from, to); isWeight(weight)) {
+        if(const auto weight = row[to]; isWeight(weight)) {
 
             ret = callback(to, weight);
         }
@@ -89,7 +91,7 @@ Graph::Node MatrixGraph::forEachIngress(const Node to, const ProgressCall& callb
             continue;
         }
 
-        if(const auto weight = getWeight(from, to); isWeight(weight)) {
+        if(const auto weight = graph[from][to]; isWeight(weight)) {
 
             ret = callback(from, weight);
         }
@@ -125,9 +127,10 @@ Graph::Node MatrixGraph::forEachLightDigress(const Node from, const ProgressCall
     return ret;
 }
 
-const Graph::EdgeList MatrixGraph::getEdges() const {
+Graph::EdgeList MatrixGraph::getEdges() const {
 
     EdgeList ret;
+    ret.reserve(getEdgeCount());
 
     for(Node from(0); from < graph.size(); ++from) {
 
@@ -144,12 +147,12 @@ const Graph::EdgeList MatrixGraph::getEdges() const {
                     continue;
                 }
                
-                ret.push_front({from, to, weight});
+                ret.push_back({from, to, weight});
             }
         }
     }
 
-    return move(ret);
+    return ret;
 }
 
 bool MatrixGraph::haveNode(const Node node) const {
@@ -164,7 +167,7 @@ Graph::Weight MatrixGraph::getWeight(const Node from, const Node to) const {
         return graph[from][to];
     }
 
-    return NAN;
+    return NO_WEIGHT;
 }
 
 void MatrixGraph::addNode(const Node node) {
@@ -173,18 +176,21 @@ void MatrixGraph::addNode(const Node node) {
 
     if(node >= graph.size()) {
 
+        GRANKY_TRACE("MatrixGraph::grow");
+
         for(auto it = graph.begin(); it != graph.end(); ++it) {
 
-            it->resize(node + 1, NAN);
+            it->resize(node + 1, NO_WEIGHT);
         }
 
-        graph.resize(node + 1, std::vector<Weight>(node + 1, NAN));
+        graph.resize(node + 1, std::vector<Weight>(node + 1, NO_WEIGHT));
     }
 
     if(!isWeight(graph[node][node])) {
     
         graph[node][node] = 0.0;
         ++nodeCount;
+        noteNode(node);
     }
 }
 
@@ -197,11 +203,14 @@ void MatrixGraph::addEdge(
 
     addNode(from);
     addNode(to);
+
+    const auto previous = graph[from][to];
     graph[from][to] = weight;
+    noteEdge(from, to, previous, weight);
     
     if(VERBOSE) {
 
-        std::cout << "matrix added: " << from << " " << to << " " << " "  << weight << std::endl; 
+        Trace::instant("MatrixGraph::addEdge", "from", from, "to", to);
     }
 }
 
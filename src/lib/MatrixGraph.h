@@ -39,7 +39,7 @@ public:
     MatrixGraph& operator=(const MatrixGraph&&) = delete;
     explicit MatrixGraph() {};
  
-    virtual const EdgeList getEdges() const override;
+    virtual EdgeList getEdges() const override;
     virtual bool haveNode(const Node node) const override;
     virtual Weight getWeight(const Node from, const Node to) const override;
     virtual void addNode(const Node node) override;
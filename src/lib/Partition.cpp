@@ -0,0 +1,270 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <math.h> // pow, sqrt, ceil
+
+#include <algorithm> // max, sort
+#include <cassert>
+#include <charconv> // from_chars
+#include <fstream>
+#include <limits> // numeric_limits
+#include <memory> // unique_ptr
+#include <utility> // move
+
+#include "Partition.h"
+#include "Trace.h"
+
+namespace granky {
+
+Partition::Partition(std::vector<Graph::Node> owners, const Graph::Node shards) :
+        owners(std::move(owners)), sizes(std::max<Graph::Node>(shards, 0), 0) {
+
+    for(const auto each : this->owners) {
+
+        if(Graph::isNode(each)) {
+
+            if(each >= static_cast<Graph::Node>(sizes.size())) {
+
+                sizes.resize(each + 1, 0);
+            }
+
+            ++sizes[each];
+        }
+    }
+}
+
+template<class SCORE>
+Partition Partition::stream(const Graph& graph, const Graph::Node shards, const double slack, const SCORE& score) {
+
+    std::vector<Graph::Node> nodes;
+    nodes.reserve(graph.getNodeCount());
+
+    graph.forEachNode([&nodes](Graph::Node node) -> Graph::Node {
+
+        nodes.push_back(node);
+        return -1;
+    });
+
+    std::sort(nodes.begin(), nodes.end());
+
+    const auto capacity = std::max<double>(1.0, ceil(slack * nodes.size() / shards));
+    std::vector<Graph::Node> owners(std::max<Graph::Node>(graph.getEndNode(), 0), -1);
+    std::vector<Graph::Node> sizes(shards, 0);
+    std::vector<Graph::Node> shared(shards, 0);
+
+    const Graph::ProgressCall tally = [&owners, &shared](Graph::Node neighbour, Graph::Weight) {
+
+        if(const auto owner = owners[neighbour]; Graph::isNode(owner)) {
+
+            ++shared[owner];
+        }
+
+        return -1;
+    };
+
+    for(const auto node : nodes) {
+
+        std::fill(shared.begin(), shared.end(), 0);
+        graph.forEachEgress(node, tally);
+        graph.forEachIngress(node, tally);
+
+        // ties go to the smaller shard, so that a node with no placed neighbours evens the sizes out
+        Graph::Node best = -1;
+        double bestScore = -std::numeric_limits<double>::infinity();
+
+        for(Graph::Node shard = 0; shard < shards; ++shard) {
+
+            if(sizes[shard] >= capacity) {
+
+                continue;
+            }
+
+            const auto each = score(shared[shard], sizes[shard], capacity);
+
+            if(each > bestScore || (each == bestScore && Graph::isNode(best) && sizes[shard] < sizes[best])) {
+
+                best = shard;
+                bestScore = each;
+            }
+        }
+
+        owners[node] = best;
+        ++sizes[best];
+    }
+
+    return Partition(std::move(owners), shards);
+}
+
+Partition Partition::byHash(const Graph& graph, const Graph::Node shards) {
+
+    GRANKY_TRACE("Partition::byHash");
+    assert(shards > 0);
+
+    std::vector<Graph::Node> owners(std::max<Graph::Node>(graph.getEndNode(), 0), -1);
+
+    graph.forEachNode([&owners, shards](Graph::Node node) -> Graph::Node {
+
+        // a multiplicative hash, so that runs of IDs do not land together
+        owners[node] = static_cast<Graph::Node>((static_cast<uint64_t>(node) * 0x9E3779B97F4A7C15ull >> 32) % shards);
+        return -1;
+    });
+
+    return Partition(std::move(owners), shards);
+}
+
+Partition Partition::byLDG(const Graph& graph, const Graph::Node shards, const double slack) {
+
+    GRANKY_TRACE("Partition::byLDG");
+    assert(shards > 0 && slack >= 1.0);
+
+    return stream(graph, shards, slack, [](Graph::Node shared, Graph::Node size, double capacity) {
+
+        return shared * (1.0 - size / capacity);
+    });
+}
+
+Partition Partition::byFennel(const Graph& graph, const Graph::Node shards, const double gamma, const double slack) {
+
+    GRANKY_TRACE("Partition::byFennel");
+    assert(shards > 0 && slack >= 1.0);
+
+    const double nodes = std::max<Graph::Node>(graph.getNodeCount(), 1);
+    const double alpha = sqrt(static_cast<double>(shards)) * graph.getEdgeCount() / pow(nodes, 1.5);
+
+    return stream(graph, shards, slack, [alpha, gamma](Graph::Node shared, Graph::Node size, double) {
+
+        return shared - alpha * gamma * pow(static_cast<double>(size), gamma - 1.0);
+    });
+}
+
+Graph::Node Partition::getShardCount() const {
+
+    return static_cast<Graph::Node>(sizes.size());
+}
+
+Graph::Node Partition::getOwner(const Graph::Node node) const {
+
+    return Graph::isNode(node) && node < static_cast<Graph::Node>(owners.size()) ? owners[node] : -1;
+}
+
+Graph::Node Partition::getSize(const Graph::Node shard) const {
+
+    return shard < getShardCount() ? sizes[shard] : 0;
+}
+
+size_t Partition::getEdgeCut(const Graph& graph) const {
+
+    size_t ret = 0;
+
+    graph.forEachEdge([this, &ret](Graph::Node from, Graph::Node to, Graph::Weight) -> Graph::Node {
+
+        ret += getOwner(from) != getOwner(to);
+        return -1;
+    });
+
+    return ret;
+}
+
+std::string Partition::getShardFile(std::string_view prefix, const Graph::Node shard) {
+
+    return std::string(prefix) + "." + std::to_string(shard) + ".gky";
+}
+
+bool Partition::write(const Graph& graph, std::string_view prefix) const {
+
+    GRANKY_TRACE("Partition::write");
+
+    std::ofstream parts(std::string(prefix) + ".parts");
+
+    for(const auto each : owners) {
+
+        parts << each << "\n";
+    }
+
+    std::vector<std::unique_ptr<std::ofstream>> shards;
+    bool ret = static_cast<bool>(parts);
+
+    for(Graph::Node shard = 0; shard < getShardCount(); ++shard) {
+
+        shards.emplace_back(new std::ofstream(getShardFile(prefix, shard)));
+        ret = ret && *shards.back();
+    }
+
+    for(Graph::Node node = 0; node < static_cast<Graph::Node>(owners.size()); ++node) {
+
+        if(Graph::isNode(owners[node])) {
+
+            *shards[owners[node]] << node << "\n";
+        }
+    }
+
+    graph.forEachEdge([this, &shards](Graph::Node from, Graph::Node to, Graph::Weight weight) -> Graph::Node {
+
+        const auto tail = getOwner(from);
+        const auto head = getOwner(to);
+
+        if(Graph::isNode(tail)) {
+
+            *shards[tail] << from << " " << to << " " << weight << "\n";
+        }
+
+        if(Graph::isNode(head) && head != tail) {
+
+            *shards[head] << from << " " << to << " " << weight << "\n";
+        }
+
+        return -1;
+    });
+
+    for(const auto& each : shards) {
+
+        each->flush();
+        ret = ret && *each;
+    }
+
+    return ret;
+}
+
+bool Partition::read(std::string_view prefix) {
+
+    std::ifstream in(std::string(prefix) + ".parts");
+    std::vector<Graph::Node> read;
+    std::string line;
+
+    while(std::getline(in, line)) {
+
+        Graph::Node owner = -1;
+
+        if(const auto [end, error] = std::from_chars(line.data(), line.data() + line.size(), owner);
+                error != std::errc() || end != line.data() + line.size()) {
+
+            *this = Partition();
+            return false;
+        }
+
+        read.push_back(owner);
+    }
+
+    *this = Partition(std::move(read));
+    return !in.bad() && getShardCount() > 0;
+}
+
+} // namespace granky
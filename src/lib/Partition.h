@@ -0,0 +1,109 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_PARTITION_H
+#define GRANKY_LIB_PARTITION_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * An assignment of every node of a graph to one of a number of shards, so
+ * that a graph too large for one process can be split between several.
+ *
+ * The streaming partitioners take nodes once each, in order of ID, and place
+ * each in the shard that already holds most of its neighbours, taking edges
+ * in either direction, less a penalty for that shard's size. Few edges then
+ * cross between shards, and so little has to travel between the processes
+ * that hold them. byHash is the baseline they are measured against.
+ *
+ * Every partitioner needs at least one shard, and a slack of at least one.
+ *
+ * write stores the partition as PREFIX.parts, in the format of METIS: line n
+ * holds the shard of node n, or -1 where there is no node n. Each shard goes
+ * to PREFIX.SHARD.gky, holding a line for each node it owns and every edge
+ * with either end in it, so that both egresses and ingresses of its own
+ * nodes are at hand. Edges crossing shards are written to both.
+ */
+class Partition {
+
+public:
+    Partition() = default;
+
+    /**
+     * owners[n] is the shard of node n, or -1. There are at least shards shards,
+     * and as many more as the owners name.
+     */
+    explicit Partition(std::vector<Graph::Node> owners, const Graph::Node shards = 0);
+
+    static Partition byHash(const Graph& graph, const Graph::Node shards);
+
+    /**
+     * Linear deterministic greedy: each node goes to the shard maximising the
+     * number of its neighbours there times 1 - size / capacity, where the
+     * capacity is slack times an even share of the nodes.
+     */
+    static Partition byLDG(const Graph& graph, const Graph::Node shards, const double slack = 1.05);
+
+    /**
+     * Fennel: each node goes to the shard maximising the number of its
+     * neighbours there less alpha * gamma * size ^ (gamma - 1), with alpha
+     * chosen from the edge and node counts, and never past the same capacity.
+     */
+    static Partition byFennel(const Graph& graph, const Graph::Node shards, const double gamma = 1.5, const double slack = 1.05);
+
+    Graph::Node getShardCount() const;
+    Graph::Node getOwner(const Graph::Node node) const;
+    Graph::Node getSize(const Graph::Node shard) const;
+
+    /**
+     * The number of edges whose ends lie in different shards.
+     */
+    size_t getEdgeCut(const Graph& graph) const;
+
+    /**
+     * Writes PREFIX.parts and one PREFIX.SHARD.gky per shard, returning false if any cannot be written.
+     */
+    bool write(const Graph& graph, std::string_view prefix) const;
+
+    /**
+     * Reads PREFIX.parts back, returning false, and leaving the partition empty, if it cannot.
+     */
+    bool read(std::string_view prefix);
+
+    static std::string getShardFile(std::string_view prefix, const Graph::Node shard);
+
+private:
+    std::vector<Graph::Node> owners;
+    std::vector<Graph::Node> sizes;
+
+    template<class SCORE>
+    static Partition stream(const Graph& graph, const Graph::Node shards, const double slack, const SCORE& score);
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_PARTITION_H
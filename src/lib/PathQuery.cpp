@@ -0,0 +1,267 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "PathQuery.h"
+
+namespace granky {
+
+BidirectionalDijkstra::BidirectionalDijkstra() {
+
+    relax = [this](Graph::Node to, Graph::Weight w) {
+
+        GRANKY_STAT(examined, 1);
+        GRANKY_STAT(callbacks, 1);
+        const auto reach = side->distance[current] + w;
+
+        if(!side->visit(to, current, reach)) {
+
+            return -1;
+        }
+
+        // every improvement on either side may complete a shorter path
+        if(const auto rest = other->distance[to]; Graph::isWeight(rest)) {
+
+            if(!Graph::isWeight(weight) || reach + rest < weight) {
+
+                weight = reach + rest;
+                meet = to;
+            }
+        }
+
+        return -1;
+    };
+}
+
+void BidirectionalDijkstra::init(Graph* g) {
+
+    GRANKY_PHASE("init");
+    assert(g);
+
+    if(graph != g) {
+
+        graph = g;
+        forward.distance.clear();
+        forward.touched.clear();
+        backward.distance.clear();
+        backward.touched.clear();
+    }
+
+    reserve();
+}
+
+void BidirectionalDijkstra::execute() {
+
+    GRANKY_PHASE("execute");
+    GRANKY_TRACE("BidirectionalDijkstra::execute");
+    cachedTable.reset();
+    assert(graph && table && graph->isNode(source) && graph->isNode(sink));
+
+    // a table that is not the forward side's own is replaced by reserve
+    if(forward.parent != table.get()) {
+
+        forward.parent = nullptr;
+    }
+
+    forward.reset();
+    backward.reset();
+    reserve();
+
+    node = -1;
+    weight = Graph::NO_WEIGHT;
+    meet = -1;
+    expanded = 0;
+    sequence.clear();
+
+    if(!graph->haveNode(source) || !graph->haveNode(sink)) {
+
+        return;
+    }
+
+    forward.visit(source, source, 0.0);
+    backward.visit(sink, sink, 0.0);
+
+    if(source == sink) {
+
+        weight = 0.0;
+        meet = source;
+    }
+
+    while(!forward.heap.empty() || !backward.heap.empty()) {
+
+        const auto ahead = forward.top();
+        const auto behind = backward.top();
+
+        // no path through an unsettled node can be shorter than both frontiers together,
+        // and an exhausted frontier is checked apart so that integer weights cannot overflow
+        if(Graph::isWeight(weight) && (ahead == Graph::MAX_WEIGHT || behind == Graph::MAX_WEIGHT || ahead + behind >= weight)) {
+
+            break;
+        }
+
+        if(ahead == Graph::MAX_WEIGHT && behind == Graph::MAX_WEIGHT) {
+
+            break;
+        }
+
+        const bool isForward = ahead <= behind;
+        side = isForward ? &forward : &backward;
+        other = isForward ? &backward : &forward;
+
+        std::pop_heap(side->heap.begin(), side->heap.end(), std::greater<Entry>());
+        const auto top = side->heap.back();
+        side->heap.pop_back();
+
+        if(top.reach > side->distance[top.node]) {
+
+            continue;
+        }
+
+        ++expanded;
+        GRANKY_STAT(visited, 1);
+        current = top.node;
+
+        if(isForward) {
+
+            graph->forEachEgress(current, relax);
+        }
+        else {
+
+            graph->forEachIngress(current, relax);
+        }
+    }
+
+    if(!Graph::isNode(meet)) {
+
+        return;
+    }
+
+    node = sink;
+
+    // the forward half is walked back from the meeting node, then turned around
+    for(Graph::Node to = meet; to != source;) {
+
+        const auto from = forward.parent->get(to);
+        sequence.push_back({from, to, graph->getWeight(from, to)});
+        to = from;
+    }
+
+    std::reverse(sequence.begin(), sequence.end());
+
+    for(Graph::Node from = meet; from != sink;) {
+
+        const auto to = backward.parent->get(from);
+        sequence.push_back({from, to, graph->getWeight(from, to)});
+        from = to;
+    }
+}
+
+Graph::Node BidirectionalDijkstra::yieldExpanded() const {
+
+    return expanded;
+}
+
+std::shared_ptr<const Query::Extra> BidirectionalDijkstra::saveExtra() const {
+
+    return std::make_shared<const Expanded>(expanded);
+}
+
+void BidirectionalDijkstra::restoreExtra(const Extra& extra) {
+
+    expanded = static_cast<const Expanded&>(extra).expanded;
+}
+
+void BidirectionalDijkstra::reserve() {
+
+    const auto end = static_cast<size_t>(graph->getEndNode());
+
+    if(!forward.parent || forward.distance.size() < end) {
+
+        auto forwardLoan = TablePool::local().borrow(end);
+        auto backwardLoan = TablePool::local().borrow(end);
+        GRANKY_STAT(allocations, 2);
+        forward.parent = forwardLoan.get();
+        backward.parent = backwardLoan.get();
+        table = std::move(forwardLoan);
+        backwardTable = std::move(backwardLoan);
+    }
+
+    forward.reserve(end);
+    backward.reserve(end);
+}
+
+void BidirectionalDijkstra::Side::reserve(const size_t end) {
+
+    if(distance.size() < end) {
+
+        distance.resize(end, Graph::NO_WEIGHT);
+    }
+}
+
+void BidirectionalDijkstra::Side::reset() {
+
+    for(const auto each : touched) {
+
+        distance[each] = Graph::NO_WEIGHT;
+    }
+
+    if(parent) {
+
+        parent->reset();
+    }
+
+    touched.clear();
+    heap.clear();
+}
+
+bool BidirectionalDijkstra::Side::visit(const Graph::Node to, const Graph::Node from, const Graph::Weight w) {
+
+    const auto known = distance[to];
+
+    if(Graph::isWeight(known) && known <= w) {
+
+        return false;
+    }
+
+    if(!Graph::isWeight(known)) {
+
+        touched.push_back(to);
+    }
+
+    distance[to] = w;
+    parent->set(to, from);
+    heap.push_back({w, to});
+    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    return true;
+}
+
+Graph::Weight BidirectionalDijkstra::Side::top() {
+
+    // drop stale entries so that the stopping test sees the real frontier
+    while(!heap.empty() && heap.front().reach > distance[heap.front().node]) {
+
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        heap.pop_back();
+    }
+
+    return heap.empty() ? Graph::MAX_WEIGHT : heap.front().reach;
+}
+
+} // namespace granky
@@ -0,0 +1,347 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_PATHQUERY_H
+#define GRANKY_LIB_PATHQUERY_H
+
+#include <algorithm> // push_heap, pop_heap, reverse
+#include <cassert>
+#include <functional> // greater
+#include <memory> // make_shared
+#include <utility> // move
+#include <vector>
+
+#include "Query.h"
+
+namespace granky {
+
+/**
+ * Point-to-point shortest path queries.
+ *
+ * All path queries read source and sink through setSource and setSink, and
+ * leave their results as follows:
+ * * yieldWeight: the length of the shortest path, or Graph::NO_WEIGHT if the sink is unreachable.
+ * * yieldNode: the sink if it was reached, otherwise -1.
+ * * yieldSequence: the edges of the shortest path, in order from source to sink.
+ * * yieldTable: the parent of every node reached by the last execute.
+ *
+ * Heaps and distances are kept between calls to execute, and are only cleared
+ * where the previous call touched them, while parent tables are EpochTallies
+ * borrowed from a TablePool and cleared in constant time. Repeated queries on
+ * one graph therefore do not pay for a full reset.
+ */
+
+/**
+ * A heuristic that always estimates zero, which makes AStar equivalent to Dijkstra.
+ */
+struct ZeroHeuristic {
+
+    inline Graph::Weight operator () (const Graph::Node, const Graph::Node) const {
+
+        return 0.0;
+    }
+};
+
+/**
+ * A* search, guided by a HEURISTIC callable of the form
+ * Graph::Weight(Graph::Node node, Graph::Node sink).
+ *
+ * The heuristic must never overestimate the remaining distance to the sink.
+ * If it is also consistent no node is expanded twice; otherwise nodes are
+ * reopened as needed and the result is still exact.
+ */
+template<class HEURISTIC>
+class AStar : public Query {
+
+public:
+    explicit AStar(HEURISTIC h = HEURISTIC());
+    virtual void init(Graph* graph) override;
+    virtual void execute() override;
+
+    /**
+     * The number of nodes popped from the heap and expanded by the last execute.
+     */
+    Graph::Node yieldExpanded() const;
+
+    virtual std::shared_ptr<const Extra> saveExtra() const override;
+    virtual void restoreExtra(const Extra& extra) override;
+
+private:
+    struct Entry {
+
+        Graph::Weight rank;
+        Graph::Weight reach;
+        Graph::Node node;
+
+        inline bool operator > (const Entry& other) const {
+
+            return rank > other.rank;
+        }
+    };
+
+    HEURISTIC heuristic;
+    std::vector<Entry> heap;
+    std::vector<Graph::Weight> distance;
+    std::vector<Graph::Node> touched;
+    EpochTally* parents = nullptr;
+    Graph::ProgressCall relax;
+    Graph::Node current = -1;
+    Graph::Node expanded = 0;
+
+    void reserve();
+    void reset();
+    void visit(const Graph::Node node, const Graph::Node parent, const Graph::Weight w);
+};
+
+/**
+ * Bidirectional Dijkstra.
+ *
+ * Searches forward from the source along egresses and backward from the sink
+ * along ingresses, always advancing the side with the nearer frontier, and
+ * stops once the two frontiers together are no closer than the best path
+ * found joining them. yieldTable holds the forward half of the search.
+ */
+class BidirectionalDijkstra : public Query {
+
+public:
+    BidirectionalDijkstra();
+    virtual void init(Graph* graph) override;
+    virtual void execute() override;
+
+    /**
+     * The number of nodes expanded by both sides of the last execute.
+     */
+    Graph::Node yieldExpanded() const;
+
+    virtual std::shared_ptr<const Extra> saveExtra() const override;
+    virtual void restoreExtra(const Extra& extra) override;
+
+private:
+    struct Entry {
+
+        Graph::Weight reach;
+        Graph::Node node;
+
+        inline bool operator > (const Entry& other) const {
+
+            return reach > other.reach;
+        }
+    };
+
+    struct Side {
+
+        std::vector<Entry> heap;
+        std::vector<Graph::Weight> distance;
+        std::vector<Graph::Node> touched;
+        EpochTally* parent = nullptr;
+
+        void reserve(const size_t end);
+        void reset();
+        bool visit(const Graph::Node node, const Graph::Node from, const Graph::Weight w);
+        Graph::Weight top();
+    };
+
+    Graph::Table::Instance backwardTable;
+    Side forward;
+    Side backward;
+    Side* side = nullptr;
+    Side* other = nullptr;
+    Graph::ProgressCall relax;
+    Graph::Node current = -1;
+    Graph::Node meet = -1;
+    Graph::Node expanded = 0;
+
+    void reserve();
+};
+
+template<class HEURISTIC>
+AStar<HEURISTIC>::AStar(HEURISTIC h) : heuristic(std::move(h)) {
+
+    // Capturing only this keeps the callback within std::function's local storage.
+    relax = [this](Graph::Node to, Graph::Weight w) {
+
+        GRANKY_STAT(examined, 1);
+        GRANKY_STAT(callbacks, 1);
+        visit(to, current, distance[current] + w);
+        return -1;
+    };
+}
+
+template<class HEURISTIC>
+void AStar<HEURISTIC>::init(Graph* g) {
+
+    GRANKY_PHASE("init");
+    assert(g);
+
+    if(graph != g) {
+
+        graph = g;
+        parents = nullptr;
+        distance.clear();
+        touched.clear();
+    }
+
+    reserve();
+}
+
+template<class HEURISTIC>
+void AStar<HEURISTIC>::execute() {
+
+    GRANKY_PHASE("execute");
+    GRANKY_TRACE("AStar::execute");
+    cachedTable.reset();
+    assert(graph && table && graph->isNode(source) && graph->isNode(sink));
+
+    reset();
+    reserve();
+
+    node = -1;
+    weight = Graph::NO_WEIGHT;
+    expanded = 0;
+    sequence.clear();
+
+    if(!graph->haveNode(source) || !graph->haveNode(sink)) {
+
+        return;
+    }
+
+    visit(source, source, 0.0);
+
+    while(!heap.empty()) {
+
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        const auto top = heap.back();
+        heap.pop_back();
+
+        // stale entries are left behind whenever a node's distance improves
+        if(top.reach > distance[top.node]) {
+
+            continue;
+        }
+
+        ++expanded;
+        GRANKY_STAT(visited, 1);
+
+        if(top.node == sink) {
+
+            break;
+        }
+
+        current = top.node;
+        graph->forEachEgress(current, relax);
+    }
+
+    if(!Graph::isWeight(distance[sink])) {
+
+        return;
+    }
+
+    node = sink;
+    weight = distance[sink];
+
+    // parents lead back from the sink, so the path is walked backwards and turned around
+    for(Graph::Node to = sink; to != source;) {
+
+        const auto from = parents->get(to);
+        sequence.push_back({from, to, graph->getWeight(from, to)});
+        to = from;
+    }
+
+    std::reverse(sequence.begin(), sequence.end());
+}
+
+template<class HEURISTIC>
+Graph::Node AStar<HEURISTIC>::yieldExpanded() const {
+
+    return expanded;
+}
+
+template<class HEURISTIC>
+std::shared_ptr<const Query::Extra> AStar<HEURISTIC>::saveExtra() const {
+
+    return std::make_shared<const Expanded>(expanded);
+}
+
+template<class HEURISTIC>
+void AStar<HEURISTIC>::restoreExtra(const Extra& extra) {
+
+    expanded = static_cast<const Expanded&>(extra).expanded;
+}
+
+template<class HEURISTIC>
+void AStar<HEURISTIC>::reserve() {
+
+    const auto end = static_cast<size_t>(graph->getEndNode());
+
+    if(distance.size() < end || table.get() != parents) {
+
+        distance.resize(end, Graph::NO_WEIGHT);
+        auto loan = TablePool::local().borrow(end);
+        GRANKY_STAT(allocations, 1);
+        parents = loan.get();
+        table = std::move(loan);
+    }
+}
+
+template<class HEURISTIC>
+void AStar<HEURISTIC>::reset() {
+
+    // a table that is not the search's own is replaced by reserve
+    const bool own = table.get() == parents;
+
+    for(const auto each : touched) {
+
+        distance[each] = Graph::NO_WEIGHT;
+    }
+
+    if(own) {
+
+        parents->reset();
+    }
+
+    touched.clear();
+    heap.clear();
+}
+
+template<class HEURISTIC>
+void AStar<HEURISTIC>::visit(const Graph::Node to, const Graph::Node parent, const Graph::Weight w) {
+
+    const auto known = distance[to];
+
+    if(Graph::isWeight(known) && known <= w) {
+
+        return;
+    }
+
+    if(!Graph::isWeight(known)) {
+
+        touched.push_back(to);
+    }
+
+    distance[to] = w;
+    parents->set(to, parent);
+    heap.push_back({w + heuristic(to, sink), w, to});
+    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+}
+
+} // namespace granky
+
+#endif // GRANKY_LIB_PATHQUERY_H
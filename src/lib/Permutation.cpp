@@ -0,0 +1,444 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <math.h> // log2
+
+#include <algorithm> // sort, reverse, max
+#include <cstdlib> // llabs
+#include <utility> // pair
+
+#include "Permutation.h"
+#include "Trace.h"
+
+namespace granky {
+
+namespace {
+
+/**
+ * The graph with edges taken in either direction, on dense indices in order of
+ * original ID. Counts says how many directed edges join each pair, one or two.
+ */
+struct Adjacency {
+
+    std::vector<Graph::Node> nodes;
+    std::vector<size_t> offsets;
+    std::vector<Graph::Node> neighbours;
+    std::vector<Graph::Node> counts;
+
+    explicit Adjacency(const Graph& graph) {
+
+        GRANKY_TRACE("Permutation::Adjacency");
+
+        std::vector<Graph::Node> dense(std::max<Graph::Node>(graph.getEndNode(), 0), -1);
+        nodes.reserve(graph.getNodeCount());
+
+        graph.forEachNode([this](Graph::Node node) -> Graph::Node {
+
+            nodes.push_back(node);
+            return -1;
+        });
+
+        std::sort(nodes.begin(), nodes.end());
+
+        for(size_t i = 0; i < nodes.size(); ++i) {
+
+            dense[nodes[i]] = static_cast<Graph::Node>(i);
+        }
+
+        std::vector<Graph::Node> around;
+        offsets.reserve(nodes.size() + 1);
+        offsets.push_back(0);
+
+        const Graph::ProgressCall collect = [&around, &dense](Graph::Node node, Graph::Weight) {
+
+            around.push_back(dense[node]);
+            return -1;
+        };
+
+        for(size_t i = 0; i < nodes.size(); ++i) {
+
+            around.clear();
+            graph.forEachEgress(nodes[i], collect);
+            graph.forEachIngress(nodes[i], collect);
+            std::sort(around.begin(), around.end());
+
+            for(size_t j = 0; j < around.size(); ++j) {
+
+                if(around[j] == static_cast<Graph::Node>(i)) {
+
+                    continue;
+                }
+
+                if(j && around[j] == around[j - 1]) {
+
+                    ++counts.back();
+                    continue;
+                }
+
+                neighbours.push_back(around[j]);
+                counts.push_back(1);
+            }
+
+            offsets.push_back(neighbours.size());
+        }
+    }
+
+    inline Graph::Node getDegree(const size_t index) const {
+
+        return static_cast<Graph::Node>(offsets[index + 1] - offsets[index]);
+    }
+};
+
+} // namespace
+
+Permutation::Permutation(const std::vector<Graph::Node>& order) : backward(order) {
+
+    Graph::Node end = 0;
+
+    for(const auto each : order) {
+
+        end = std::max(end, each + 1);
+    }
+
+    forward.assign(end, -1);
+
+    for(size_t i = 0; i < order.size(); ++i) {
+
+        forward[order[i]] = static_cast<Graph::Node>(i);
+    }
+}
+
+Permutation Permutation::byDegree(const Graph& graph) {
+
+    GRANKY_TRACE("Permutation::byDegree");
+
+    const Adjacency adjacency(graph);
+    std::vector<Graph::Node> degrees(adjacency.nodes.size(), 0);
+    std::vector<Graph::Node> order(adjacency.nodes.size());
+
+    for(size_t i = 0; i < order.size(); ++i) {
+
+        for(auto j = adjacency.offsets[i]; j < adjacency.offsets[i + 1]; ++j) {
+
+            degrees[i] += adjacency.counts[j];
+        }
+
+        order[i] = static_cast<Graph::Node>(i);
+    }
+
+    // ties keep their original order
+    std::stable_sort(order.begin(), order.end(), [&degrees](Graph::Node a, Graph::Node b) {
+
+        return degrees[a] > degrees[b];
+    });
+
+    for(auto& each : order) {
+
+        each = adjacency.nodes[each];
+    }
+
+    return Permutation(order);
+}
+
+Permutation Permutation::byCuthillMcKee(const Graph& graph) {
+
+    GRANKY_TRACE("Permutation::byCuthillMcKee");
+
+    const Adjacency adjacency(graph);
+    const auto count = adjacency.nodes.size();
+    std::vector<Graph::Node> starts(count);
+    std::vector<Graph::Node> order;
+    std::vector<bool> visited(count, false);
+    order.reserve(count);
+
+    const auto byDegree = [&adjacency](Graph::Node a, Graph::Node b) {
+
+        return adjacency.getDegree(a) < adjacency.getDegree(b);
+    };
+
+    for(size_t i = 0; i < count; ++i) {
+
+        starts[i] = static_cast<Graph::Node>(i);
+    }
+
+    std::stable_sort(starts.begin(), starts.end(), byDegree);
+
+    // the order doubles as the queue of each breadth first search
+    for(const auto start : starts) {
+
+        if(visited[start]) {
+
+            continue;
+        }
+
+        visited[start] = true;
+        order.push_back(start);
+
+        for(auto head = order.size() - 1; head < order.size(); ++head) {
+
+            const auto node = order[head];
+            const auto first = order.size();
+
+            for(auto j = adjacency.offsets[node]; j < adjacency.offsets[node + 1]; ++j) {
+
+                if(const auto next = adjacency.neighbours[j]; !visited[next]) {
+
+                    visited[next] = true;
+                    order.push_back(next);
+                }
+            }
+
+            std::stable_sort(order.begin() + first, order.end(), byDegree);
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+
+    for(auto& each : order) {
+
+        each = adjacency.nodes[each];
+    }
+
+    return Permutation(order);
+}
+
+Permutation Permutation::byCommunity(const Graph& graph) {
+
+    GRANKY_TRACE("Permutation::byCommunity");
+
+    const Adjacency adjacency(graph);
+    const auto count = adjacency.nodes.size();
+    std::vector<std::vector<std::pair<Graph::Node, double>>> edges(count);
+    std::vector<double> degrees(count, 0.0);
+    std::vector<Graph::Node> into(count);
+    std::vector<Graph::Node> firstChild(count, -1);
+    std::vector<Graph::Node> nextSibling(count, -1);
+    std::vector<Graph::Node> ascending(count);
+    double total = 0.0;
+
+    for(size_t i = 0; i < count; ++i) {
+
+        for(auto j = adjacency.offsets[i]; j < adjacency.offsets[i + 1]; ++j) {
+
+            edges[i].push_back({adjacency.neighbours[j], adjacency.counts[j]});
+            degrees[i] += adjacency.counts[j];
+        }
+
+        total += degrees[i];
+        into[i] = static_cast<Graph::Node>(i);
+        ascending[i] = static_cast<Graph::Node>(i);
+    }
+
+    std::stable_sort(ascending.begin(), ascending.end(), [&degrees](Graph::Node a, Graph::Node b) {
+
+        return degrees[a] < degrees[b];
+    });
+
+    const auto find = [&into](Graph::Node node) {
+
+        while(into[node] != node) {
+
+            node = into[node] = into[into[node]];
+        }
+
+        return node;
+    };
+
+    std::vector<double> shared(count, 0.0);
+    std::vector<Graph::Node> touched;
+    std::vector<Graph::Node> roots;
+
+    for(const auto node : ascending) {
+
+        // total the weight joining node to each neighbouring community
+        for(const auto& [neighbour, weight] : edges[node]) {
+
+            const auto community = find(neighbour);
+
+            if(community == node) {
+
+                continue;
+            }
+
+            if(shared[community] == 0.0) {
+
+                touched.push_back(community);
+            }
+
+            shared[community] += weight;
+        }
+
+        // merging with c raises modularity by 2 * (w / total - degree * degree(c) / total^2)
+        Graph::Node best = -1;
+        double bestGain = 0.0;
+        edges[node].clear();
+
+        for(const auto community : touched) {
+
+            const auto gain = shared[community] - degrees[node] * degrees[community] / total;
+
+            if(gain > bestGain) {
+
+                best = community;
+                bestGain = gain;
+            }
+
+            edges[node].push_back({community, shared[community]});
+            shared[community] = 0.0;
+        }
+
+        touched.clear();
+
+        if(!Graph::isNode(best)) {
+
+            roots.push_back(node);
+            continue;
+        }
+
+        into[node] = best;
+        degrees[best] += degrees[node];
+        edges[best].insert(edges[best].end(), edges[node].begin(), edges[node].end());
+        std::vector<std::pair<Graph::Node, double>>().swap(edges[node]);
+        nextSibling[node] = firstChild[best];
+        firstChild[best] = node;
+    }
+
+    std::vector<Graph::Node> order;
+    std::vector<Graph::Node> stack;
+    order.reserve(count);
+
+    for(const auto root : roots) {
+
+        stack.push_back(root);
+
+        while(!stack.empty()) {
+
+            const auto node = stack.back();
+            stack.pop_back();
+            order.push_back(adjacency.nodes[node]);
+
+            for(auto child = firstChild[node]; Graph::isNode(child); child = nextSibling[child]) {
+
+                stack.push_back(child);
+            }
+        }
+    }
+
+    return Permutation(order);
+}
+
+Graph::Node Permutation::translate(const Graph::Node node) const {
+
+    if(!Graph::isNode(node)) {
+
+        return node;
+    }
+
+    return node < static_cast<Graph::Node>(forward.size()) ? forward[node] : -1;
+}
+
+Graph::Node Permutation::restore(const Graph::Node node) const {
+
+    if(!Graph::isNode(node)) {
+
+        return node;
+    }
+
+    return node < static_cast<Graph::Node>(backward.size()) ? backward[node] : -1;
+}
+
+Graph::EdgeList Permutation::translate(const Graph::EdgeList& edges) const {
+
+    Graph::EdgeList ret;
+    ret.reserve(edges.size());
+
+    for(const auto& each : edges) {
+
+        ret.push_back({translate(each.from), translate(each.to), each.weight});
+    }
+
+    return ret;
+}
+
+Graph::EdgeList Permutation::restore(const Graph::EdgeList& edges) const {
+
+    Graph::EdgeList ret;
+    ret.reserve(edges.size());
+
+    for(const auto& each : edges) {
+
+        ret.push_back({restore(each.from), restore(each.to), each.weight});
+    }
+
+    return ret;
+}
+
+Graph::Node Permutation::getNodeCount() const {
+
+    return static_cast<Graph::Node>(backward.size());
+}
+
+void Permutation::relabel(const Graph& source, Graph& target) const {
+
+    GRANKY_TRACE("Permutation::relabel");
+
+    // nodes first and in order, so that array backends grow once and isolated nodes survive
+    for(const auto each : backward) {
+
+        if(source.haveNode(each)) {
+
+            target.addNode(translate(each));
+        }
+    }
+
+    source.forEachEdgeBlock([this, &target](const Graph::EdgeList& block) -> Graph::Node {
+
+        for(const auto& each : block) {
+
+            const auto from = translate(each.from);
+            const auto to = translate(each.to);
+
+            if(Graph::isNode(from) && Graph::isNode(to)) {
+
+                target.addEdge(from, to, each.weight);
+            }
+        }
+
+        return -1;
+    });
+}
+
+double Permutation::getMeanLogGap(const Graph& graph) {
+
+    double sum = 0.0;
+    size_t count = 0;
+
+    graph.forEachEdge([&sum, &count](Graph::Node from, Graph::Node to, Graph::Weight) -> Graph::Node {
+
+        sum += log2(1.0 + llabs(static_cast<long long>(from) - to));
+        ++count;
+        return -1;
+    });
+
+    return count ? sum / count : 0.0;
+}
+
+} // namespace granky
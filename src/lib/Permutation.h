@@ -0,0 +1,112 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_PERMUTATION_H
+#define GRANKY_LIB_PERMUTATION_H
+
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * A relabelling of the nodes of a graph, for better locality.
+ *
+ * Node IDs read from a file are often as good as random, so that neighbours
+ * lie far apart in every backend's tables and each step of a traversal misses
+ * the cache. A permutation gives the nodes of a graph new, dense IDs in an
+ * order that keeps neighbours close, and relabel copies the graph under those
+ * IDs. Queries then run on the copy, and translate and restore carry nodes,
+ * and the edges of paths, between the two sets of IDs.
+ *
+ * Nodes the permutation does not know translate to -1; leaves stay leaves.
+ */
+class Permutation {
+
+public:
+    Permutation() = default;
+
+    /**
+     * Gives the nth node of order the new ID n.
+     */
+    explicit Permutation(const std::vector<Graph::Node>& order);
+
+    /**
+     * Most joined first, counting egresses and ingresses, so that hubs share cache lines.
+     */
+    static Permutation byDegree(const Graph& graph);
+
+    /**
+     * Reverse Cuthill-McKee: a breadth first order, taking edges in either
+     * direction, from a node of least degree in each component and visiting
+     * neighbours by ascending degree, then reversed. This narrows the band
+     * around the diagonal that the edges lie in, which suits meshes and roads.
+     */
+    static Permutation byCuthillMcKee(const Graph& graph);
+
+    /**
+     * Communities numbered consecutively, after Rabbit Order: nodes are taken
+     * by ascending degree, and each is merged into the neighbouring community
+     * that raises modularity the most, if any. Nodes are then numbered depth
+     * first through the merges, so each community, and each community within
+     * it, gets a contiguous range. This suits social and web graphs.
+     */
+    static Permutation byCommunity(const Graph& graph);
+
+    Graph::Node translate(const Graph::Node node) const;
+    Graph::Node restore(const Graph::Node node) const;
+    Graph::EdgeList translate(const Graph::EdgeList& edges) const;
+    Graph::EdgeList restore(const Graph::EdgeList& edges) const;
+
+    /**
+     * The number of nodes relabelled, which is also the end node of a relabelled graph.
+     */
+    Graph::Node getNodeCount() const;
+
+    /**
+     * Adds every node and edge of source to target under their new IDs.
+     */
+    void relabel(const Graph& source, Graph& target) const;
+    template<class GRAPH_TYPE> Graph::Instance relabel(const Graph& source) const;
+
+    /**
+     * The mean over every edge of log2(1 + |from - to|), a rough gauge of how
+     * well a graph's IDs keep neighbours together: lower is better.
+     */
+    static double getMeanLogGap(const Graph& graph);
+
+private:
+    std::vector<Graph::Node> forward;
+    std::vector<Graph::Node> backward;
+};
+
+template<class GRAPH_TYPE>
+Graph::Instance Permutation::relabel(const Graph& source) const {
+
+    auto ret = Graph::create<GRAPH_TYPE>();
+    relabel(source, *ret);
+    return ret;
+}
+
+} // namespace granky
+
+#endif // GRANKY_LIB_PERMUTATION_H
@@ -24,7 +24,69 @@ const Graph::EdgeList& Query::yieldSequence() const {
 
 const Graph::Table* Query::yieldTable() const {
 
-    return table.get();
+    return cachedTable ? cachedTable.get() : table.get();
+}
+
+const Query::Stats& Query::yieldStats() const {
+
+    return stats;
+}
+
+void Query::resetStats() {
+
+    stats = Stats();
+}
+
+std::shared_ptr<const Query::Extra> Query::saveExtra() const {
+
+    return nullptr;
+}
+
+void Query::restoreExtra(const Extra& /*extra*/) {}
+
+bool Query::isCacheable() const {
+
+    return true;
+}
+
+double Query::Stats::getSeconds(std::string_view name) const {
+
+    double ret = 0.0;
+
+    for(const auto& each : phases) {
+
+        if(name == each.name) {
+
+            ret += each.seconds;
+        }
+    }
+
+    return ret;
+}
+
+double Query::Stats::getTeps() const {
+
+    const auto seconds = getSeconds("execute");
+    return seconds > 0.0 ? examined / seconds : 0.0;
+}
+
+Query::PhaseTimer::PhaseTimer(Stats& s, const char* n) :
+    stats(s), name(n), start(std::chrono::steady_clock::now()) {}
+
+Query::PhaseTimer::~PhaseTimer() {
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for(auto& each : stats.phases) {
+
+        if(std::string_view(name) == each.name) {
+
+            each.seconds += elapsed.count();
+            return;
+        }
+    }
+
+    stats.phases.push_back({name, elapsed.count()});
 }
 
 void Query::setSource(Graph::Node s) {
@@ -39,31 +101,42 @@ void Query::setSink(Graph::Node t) {
 
 void RecursiveDFS::init(Graph* s) {
 
+    GRANKY_PHASE("init");
     assert(s);
     graph = s;
     table = graph->getBlankNodeCheck();
+    GRANKY_STAT(allocations, 1);
 }
 
 void RecursiveDFS::execute() {
 
+    GRANKY_PHASE("execute");
+    GRANKY_TRACE("RecursiveDFS::execute");
+    cachedTable.reset();
     assert(graph && table && graph->isNode(source));
+
+    // blank tables are EpochTallies
+    marks = static_cast<EpochTally*>(table.get());
     node = true;
     weight = recurse(source);
 }
 
 Graph::Weight RecursiveDFS::recurse(const Graph::Node sub) {
 
-    if(Graph::isNode(table->get(sub))) {
+    if(Graph::isNode(marks->get(sub))) {
 
-        return NAN;
+        return Graph::NO_WEIGHT;
     }
 
-    table->set(sub, node);
+    marks->set(sub, node);
+    GRANKY_STAT(visited, 1);
 
     Graph::Weight ret = 0.0;
 
     const Graph::ProgressCall callback = [this, &sub, &ret](Graph::Node node, Graph::Weight w) {
 
+        GRANKY_STAT(examined, 1);
+        GRANKY_STAT(callbacks, 1);
         const auto got = recurse(node);
 
         if(Graph::isWeight(got)) {
@@ -81,17 +154,20 @@ Graph::Weight RecursiveDFS::recurse(const Graph::Node sub) {
 
 Graph::Weight RecursiveDigraphDFS::recurse(const Graph::Node sub) {
 
-    if(Graph::isNode(table->get(sub))) {
+    if(Graph::isNode(marks->get(sub))) {
 
-        return NAN;
+        return Graph::NO_WEIGHT;
     }
 
-    table->set(sub, node);
+    marks->set(sub, node);
+    GRANKY_STAT(visited, 1);
 
     Graph::Weight ret = 0.0;
 
     const Graph::ProgressCall callback = [this, &sub, &ret](Graph::Node node, Graph::Weight w) {
 
+        GRANKY_STAT(examined, 1);
+        GRANKY_STAT(callbacks, 1);
         const auto got = recurse(node);
 
         if(Graph::isWeight(got)) {
@@ -109,18 +185,27 @@ Graph::Weight RecursiveDigraphDFS::recurse(const Graph::Node sub) {
 
 void ColorComponents::init(Graph* g) {
 
+    GRANKY_PHASE("init");
     assert(g);
     graph = g;
     table = graph->getBlankNodeTally();
+    GRANKY_STAT(allocations, 1);
 }
 
 void ColorComponents::execute() {
 
+    GRANKY_PHASE("execute");
+    GRANKY_TRACE("ColorComponents::execute");
+    cachedTable.reset();
+    assert(graph && table);
+    marks = static_cast<EpochTally*>(table.get());
+
     node = 0;
     weight = 0.0;
     
     const Graph::NodeCall nodeCall = [this](Graph::Node sub) {
 
+        GRANKY_STAT(callbacks, 1);
         const auto got = recurse(sub);
 
         if(Graph::isWeight(got)) {
@@ -1,31 +1,138 @@
 #ifndef GRANKY_LIB_QUERY_H
 #define GRANKY_LIB_QUERY_H
 
+#include <chrono>
+#include <cstdint> // uint64_t
+#include <memory> // shared_ptr
+#include <string_view>
+#include <vector>
+
 #include "Graph.h"
+#include "TablePool.h"
+#include "Trace.h"
 #include "math.h"
 
+/**
+ * Instrumentation is compiled in by defining GRANKY_STATS, and compiles to
+ * nothing otherwise. GRANKY_STAT adds to a counter of the Query's Stats, and
+ * GRANKY_PHASE times the rest of the enclosing scope under the given name.
+ */
+#ifdef GRANKY_STATS
+#define GRANKY_STAT(__fld__, __amt__) (stats.__fld__ += (__amt__))
+#define GRANKY_PHASE(__nme__) const Query::PhaseTimer phaseTimer(stats, __nme__)
+#else
+#define GRANKY_STAT(__fld__, __amt__) ((void) 0)
+#define GRANKY_PHASE(__nme__) ((void) 0)
+#endif
+
 namespace granky {
 
+class QueryCache;
+
 class Query {
 
+    friend class QueryCache;
+
+public:
+    /**
+     * What queries did, summed over every init and execute since the last resetStats.
+     * Without GRANKY_STATS everything stays zero.
+     */
+    struct Stats {
+
+        struct Phase {
+
+            const char* name;
+            double seconds;
+        };
+
+        uint64_t visited = 0;
+        uint64_t examined = 0;
+        uint64_t callbacks = 0;
+        uint64_t allocations = 0;
+        std::vector<Phase> phases;
+
+        double getSeconds(std::string_view name) const;
+
+        /**
+         * Traversed edges per second: edges examined over the time spent in execute.
+         */
+        double getTeps() const;
+    };
+
+    /**
+     * Results a subclass yields beyond node, weight, sequence and table,
+     * which QueryCache keeps and restores alongside them.
+     */
+    struct Extra {
+
+        virtual ~Extra() = default;
+    };
+
+    /**
+     * The Extra of searches whose only result of their own is yieldExpanded.
+     */
+    struct Expanded : Extra {
+
+        Graph::Node expanded;
+
+        explicit Expanded(const Graph::Node e) : expanded(e) {}
+    };
+
 protected:
+    /**
+     * Adds the time from construction to destruction to a phase of stats.
+     * Phases may nest, in which case the inner time is counted in both.
+     */
+    class PhaseTimer {
+
+    public:
+        PhaseTimer(Stats& stats, const char* name);
+        ~PhaseTimer();
+
+    private:
+        Stats& stats;
+        const char* name;
+        const std::chrono::steady_clock::time_point start;
+    };
+
     Graph* graph = nullptr;
     Graph::Table::Instance table;
+
+    /**
+     * A table restored by a QueryCache hit, shared with the cache rather than
+     * copied, and shown by yieldTable in place of table until the next execute.
+     */
+    std::shared_ptr<const Graph::Table> cachedTable;
+
     Graph::Node source = -1;
     Graph::Node sink = -1;
     Graph::Node node = -1;
-    Graph::Weight weight = NAN;
+    Graph::Weight weight = Graph::NO_WEIGHT;
     Graph::EdgeList sequence;
+    Stats stats;
 
 public:
+    virtual ~Query() = default;
     void setSource(Graph::Node s);
     void setSink(Graph::Node t);
     Graph::Node yieldNode() const;
     Graph::Weight yieldWeight() const;
     const Graph::EdgeList& yieldSequence() const; 
     const Graph::Table* yieldTable() const;
+    const Stats& yieldStats() const;
+    void resetStats();
     virtual void init(Graph* graph) = 0;
     virtual void execute() = 0;
+
+    /**
+     * saveExtra returns a copy of the subclass's own results, or nullptr if it
+     * has none, and restoreExtra puts back what saveExtra returned.
+     * Queries whose results cannot be restored so return false from isCacheable.
+     */
+    virtual std::shared_ptr<const Extra> saveExtra() const;
+    virtual void restoreExtra(const Extra& extra);
+    virtual bool isCacheable() const;
 };
 
 class RecursiveQuery : public Query {
@@ -41,6 +148,9 @@ public:
     virtual void execute() override;
 
 protected:
+    // the table itself, for calls without virtual dispatch
+    EpochTally* marks = nullptr;
+
     virtual Graph::Weight recurse(const Graph::Node sub) override;
 };
 
@@ -0,0 +1,143 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+
+#include "QueryCache.h"
+
+namespace granky {
+
+QueryCache::QueryCache(const size_t c) : capacity(c) {
+
+    assert(capacity > 0);
+}
+
+bool QueryCache::execute(Query& query, const uint64_t tag) {
+
+    if(!query.isCacheable()) {
+
+        query.execute();
+        return false;
+    }
+
+    assert(query.graph);
+
+    const Key key = {typeid(query), query.source, query.sink, tag, query.graph->getVersion()};
+    std::shared_ptr<const Result> found;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        if(const auto got = index.find(key); got != index.end()) {
+
+            order.splice(order.begin(), order, got->second);
+            found = got->second->second;
+            ++stats.hits;
+        }
+        else {
+
+            ++stats.misses;
+        }
+    }
+
+    if(found) {
+
+        query.node = found->node;
+        query.weight = found->weight;
+        query.sequence = found->sequence;
+        query.cachedTable = found->table;
+
+        if(found->extra) {
+
+            query.restoreExtra(*found->extra);
+        }
+
+        return true;
+    }
+
+    // the lock is not held while executing, so two threads may both miss and both store
+    query.execute();
+
+    auto result = std::make_shared<Result>();
+    result->node = query.node;
+    result->weight = query.weight;
+    result->sequence = query.sequence;
+    result->table = query.table ? std::shared_ptr<const Graph::Table>(query.table->clone().release(), Graph::Table::Release()) : nullptr;
+    result->extra = query.saveExtra();
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if(const auto got = index.find(key); got != index.end()) {
+
+        order.splice(order.begin(), order, got->second);
+        return false;
+    }
+
+    order.emplace_front(key, std::move(result));
+    index.emplace(key, order.begin());
+
+    if(order.size() > capacity) {
+
+        index.erase(order.back().first);
+        order.pop_back();
+        ++stats.evictions;
+    }
+
+    stats.size = order.size();
+    return false;
+}
+
+QueryCache::Stats QueryCache::getStats() const {
+
+    std::lock_guard<std::mutex> guard(lock);
+    return stats;
+}
+
+void QueryCache::clear() {
+
+    std::lock_guard<std::mutex> guard(lock);
+    index.clear();
+    order.clear();
+    stats.size = 0;
+}
+
+bool QueryCache::Key::operator == (const Key& other) const {
+
+    return type == other.type
+        && source == other.source
+        && sink == other.sink
+        && tag == other.tag
+        && version == other.version;
+}
+
+size_t QueryCache::KeyHash::operator () (const Key& key) const {
+
+    size_t ret = key.type.hash_code();
+
+    for(const uint64_t each : {uint64_t(key.source), uint64_t(key.sink), key.tag, key.version}) {
+
+        ret ^= std::hash<uint64_t>()(each) + 0x9e3779b97f4a7c15ULL + (ret << 6) + (ret >> 2);
+    }
+
+    return ret;
+}
+
+} // namespace granky
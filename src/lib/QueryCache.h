@@ -0,0 +1,117 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_QUERYCACHE_H
+#define GRANKY_LIB_QUERYCACHE_H
+
+#include <cstdint> // uint64_t
+#include <list>
+#include <memory> // shared_ptr
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+
+#include "Query.h"
+
+namespace granky {
+
+/**
+ * A bounded, least-recently-used cache of Query results.
+ *
+ * Results are keyed by the query's type, source, sink, an optional tag, and
+ * the version of the graph it was initialised with. Since every change to a
+ * graph gives it a new version, a stale result is never returned; it simply
+ * ages out. Queries whose results depend on anything else, such as a
+ * heuristic or a list of sources, must distinguish themselves with the tag.
+ *
+ * A hit restores yieldNode, yieldWeight, yieldSequence and yieldTable, and
+ * whatever else the query keeps through Query::saveExtra, such as
+ * yieldExpanded, or MultiSourceBFS's distances and closeness. Queries that
+ * are not Query::isCacheable, such as DynamicShortestPaths and HierarchyQuery,
+ * are simply executed, and need not have a graph.
+ *
+ * One cache may be shared between threads. Queries themselves may not.
+ */
+class QueryCache {
+
+public:
+    struct Stats {
+
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t size;
+    };
+
+    static constexpr const size_t DEFAULT_CAPACITY = 1024;
+
+    explicit QueryCache(const size_t capacity = DEFAULT_CAPACITY);
+    QueryCache(const QueryCache&) = delete;
+    QueryCache& operator=(const QueryCache&) = delete;
+
+    /**
+     * Either restores the yields of an initialised query from the cache,
+     * or executes the query and remembers its yields.
+     * Returns true on a hit.
+     */
+    bool execute(Query& query, const uint64_t tag = 0);
+
+    Stats getStats() const;
+    void clear();
+
+private:
+    struct Key {
+
+        std::type_index type;
+        Graph::Node source;
+        Graph::Node sink;
+        uint64_t tag;
+        Graph::Version version;
+
+        bool operator == (const Key& other) const;
+    };
+
+    struct KeyHash {
+
+        size_t operator () (const Key& key) const;
+    };
+
+    struct Result {
+
+        Graph::Node node;
+        Graph::Weight weight;
+        Graph::EdgeList sequence;
+        std::shared_ptr<const Graph::Table> table;
+        std::shared_ptr<const Query::Extra> extra;
+    };
+
+    typedef std::list<std::pair<Key, std::shared_ptr<const Result>>> Order;
+
+    const size_t capacity;
+    mutable std::mutex lock;
+    Order order;
+    std::unordered_map<Key, Order::iterator, KeyHash> index;
+    Stats stats = {0, 0, 0, 0};
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_QUERYCACHE_H
@@ -0,0 +1,417 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+
+#include <algorithm> // sort, unique, min, max
+#include <random> // mt19937
+#include <utility> // pair
+
+#include "ReachabilityIndex.h"
+#include "Trace.h"
+
+namespace granky {
+
+namespace {
+
+struct Frame {
+
+    Graph::Node node;
+    size_t next;
+};
+
+template<class T>
+size_t bytes(const std::vector<T>& data) {
+
+    return data.capacity() * sizeof(T);
+}
+
+} // namespace
+
+void ReachabilityIndex::build(const Graph& graph, const size_t labels, const unsigned seed) {
+
+    GRANKY_TRACE("ReachabilityIndex::build");
+    const auto end = graph.getEndNode();
+
+    // egresses are copied into flat arrays once, rather than called back for every traversal
+    std::vector<size_t> egressOffset(end + 1, 0);
+    std::vector<Graph::Node> egress;
+
+    for(Graph::Node from = 0; from < end; ++from) {
+
+        const Graph::ProgressCall callback = [&egress](Graph::Node to, Graph::Weight) {
+
+            egress.push_back(to);
+            return -1;
+        };
+
+        graph.forEachEgress(from, callback);
+        egressOffset[from + 1] = egress.size();
+    }
+
+    // Tarjan's algorithm, unrolled. Components are numbered as they complete,
+    // so every edge between two components leads to a lower number.
+    component.assign(end, -1);
+    std::vector<Graph::Node> index(end, -1);
+    std::vector<Graph::Node> low(end, -1);
+    std::vector<Graph::Node> open;
+    std::vector<Frame> frames;
+    Graph::Node counter = 0;
+    Graph::Node components = 0;
+
+    for(Graph::Node root = 0; root < end; ++root) {
+
+        if(!graph.haveNode(root) || Graph::isNode(index[root])) {
+
+            continue;
+        }
+
+        frames.push_back({root, egressOffset[root]});
+        index[root] = low[root] = counter++;
+        open.push_back(root);
+
+        while(!frames.empty()) {
+
+            auto& frame = frames.back();
+            const auto at = frame.node;
+
+            if(frame.next < egressOffset[at + 1]) {
+
+                const auto to = egress[frame.next++];
+
+                if(!Graph::isNode(index[to])) {
+
+                    index[to] = low[to] = counter++;
+                    open.push_back(to);
+                    frames.push_back({to, egressOffset[to]});
+                }
+                else if(!Graph::isNode(component[to])) {
+
+                    low[at] = std::min(low[at], index[to]);
+                }
+
+                continue;
+            }
+
+            if(low[at] == index[at]) {
+
+                Graph::Node member;
+
+                do {
+
+                    member = open.back();
+                    open.pop_back();
+                    component[member] = components;
+                } while(member != at);
+
+                ++components;
+            }
+
+            frames.pop_back();
+
+            if(!frames.empty()) {
+
+                const auto parent = frames.back().node;
+                low[parent] = std::min(low[parent], low[at]);
+            }
+        }
+    }
+
+    std::vector<std::pair<Graph::Node, Graph::Node>> links;
+
+    for(Graph::Node from = 0; from < end; ++from) {
+
+        for(auto it = egressOffset[from]; it < egressOffset[from + 1]; ++it) {
+
+            if(component[from] != component[egress[it]]) {
+
+                links.push_back({component[from], component[egress[it]]});
+            }
+        }
+    }
+
+    std::sort(links.begin(), links.end());
+    links.erase(std::unique(links.begin(), links.end()), links.end());
+
+    offset.assign(components + 1, 0);
+    child.resize(links.size());
+
+    for(size_t i = 0; i < links.size(); ++i) {
+
+        ++offset[links[i].first + 1];
+        child[i] = links[i].second;
+    }
+
+    for(Graph::Node c = 0; c < components; ++c) {
+
+        offset[c + 1] += offset[c];
+    }
+
+    // Parents are always numbered higher than their children, so walking roots in
+    // descending order starts every tree at a component no unvisited one leads to.
+    std::vector<uint32_t> visited(components, 0);
+    tree.assign(components, {0, 0});
+    uint32_t order = 0;
+
+    for(Graph::Node root = components - 1; root >= 0; --root) {
+
+        if(visited[root]) {
+
+            continue;
+        }
+
+        visited[root] = 1;
+        tree[root].low = order++;
+        frames.push_back({root, offset[root]});
+
+        while(!frames.empty()) {
+
+            auto& frame = frames.back();
+
+            if(frame.next < offset[frame.node + 1]) {
+
+                const auto to = child[frame.next++];
+
+                if(!visited[to]) {
+
+                    visited[to] = 1;
+                    tree[to].low = order++;
+                    frames.push_back({to, offset[to]});
+                }
+
+                continue;
+            }
+
+            tree[frame.node].high = order - 1;
+            frames.pop_back();
+        }
+    }
+
+    // GRAIL: each traversal visits children from a random starting point, ranks
+    // components in post order, and widens every interval to cover its children.
+    std::mt19937 random(seed);
+    std::vector<Graph::Node> roots(components);
+    labelCount = labels;
+    label.assign(labelCount * components, {0, 0});
+
+    for(Graph::Node c = 0; c < components; ++c) {
+
+        roots[c] = components - 1 - c;
+    }
+
+    for(size_t k = 0; k < labelCount; ++k) {
+
+        auto* const interval = &label[k * components];
+        std::vector<size_t> start(components);
+        uint32_t rank = 0;
+
+        for(Graph::Node c = 0; c < components; ++c) {
+
+            const auto degree = offset[c + 1] - offset[c];
+            start[c] = degree ? random() % degree : 0;
+        }
+
+        std::fill(visited.begin(), visited.end(), 0);
+
+        if(k) {
+
+            std::shuffle(roots.begin(), roots.end(), random);
+        }
+
+        for(const auto root : roots) {
+
+            if(visited[root]) {
+
+                continue;
+            }
+
+            visited[root] = 1;
+            interval[root].low = UINT32_MAX;
+            frames.push_back({root, 0});
+
+            while(!frames.empty()) {
+
+                auto& frame = frames.back();
+                const auto at = frame.node;
+                const auto degree = offset[at + 1] - offset[at];
+
+                if(frame.next < degree) {
+
+                    const auto to = child[offset[at] + (start[at] + frame.next++) % degree];
+
+                    if(!visited[to]) {
+
+                        visited[to] = 1;
+                        interval[to].low = UINT32_MAX;
+                        frames.push_back({to, 0});
+                    }
+
+                    continue;
+                }
+
+                interval[at].high = rank++;
+                interval[at].low = std::min(interval[at].low, interval[at].high);
+
+                for(auto it = offset[at]; it < offset[at + 1]; ++it) {
+
+                    interval[at].low = std::min(interval[at].low, interval[child[it]].low);
+                }
+
+                frames.pop_back();
+            }
+        }
+    }
+
+    stamp.assign(components, 0);
+    stack.clear();
+    epoch = 0;
+    fallbacks = 0;
+}
+
+bool ReachabilityIndex::canReach(const Graph::Node from, const Graph::Node to) const {
+
+    const auto source = getComponent(from);
+    const auto sink = getComponent(to);
+
+    if(!Graph::isNode(source) || !Graph::isNode(sink)) {
+
+        return false;
+    }
+
+    if(source == sink) {
+
+        return true;
+    }
+
+    if(source < sink) {
+
+        return false;
+    }
+
+    if(tree[source].low <= tree[sink].low && tree[sink].low <= tree[source].high) {
+
+        return true;
+    }
+
+    if(!mayReach(source, sink)) {
+
+        return false;
+    }
+
+    ++fallbacks;
+    return search(source, sink);
+}
+
+Graph::Node ReachabilityIndex::getComponent(const Graph::Node node) const {
+
+    return Graph::isNode(node) && node < component.size() ? component[node] : -1;
+}
+
+Graph::Node ReachabilityIndex::getComponentCount() const {
+
+    return static_cast<Graph::Node>(tree.size());
+}
+
+size_t ReachabilityIndex::getFootprint() const {
+
+    return sizeof(*this)
+        + bytes(component)
+        + bytes(offset)
+        + bytes(child)
+        + bytes(tree)
+        + bytes(label)
+        + bytes(stamp)
+        + bytes(stack);
+}
+
+size_t ReachabilityIndex::getFallbackCount() const {
+
+    return fallbacks;
+}
+
+bool ReachabilityIndex::mayReach(const Graph::Node from, const Graph::Node to) const {
+
+    const auto components = tree.size();
+
+    for(size_t k = 0; k < labelCount; ++k) {
+
+        const auto& outer = label[k * components + from];
+        const auto& inner = label[k * components + to];
+
+        if(inner.low < outer.low || inner.high > outer.high) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ReachabilityIndex::search(const Graph::Node from, const Graph::Node to) const {
+
+    // stamps only need clearing when the epoch wraps around
+    if(++epoch == 0) {
+
+        std::fill(stamp.begin(), stamp.end(), 0);
+        epoch = 1;
+    }
+
+    stack.clear();
+    stack.push_back(from);
+    stamp[from] = epoch;
+
+    while(!stack.empty()) {
+
+        const auto at = stack.back();
+        stack.pop_back();
+
+        for(auto it = offset[at]; it < offset[at + 1]; ++it) {
+
+            const auto next = child[it];
+
+            if(next == to) {
+
+                return true;
+            }
+
+            if(stamp[next] == epoch || next < to) {
+
+                continue;
+            }
+
+            stamp[next] = epoch;
+
+            if(tree[next].low <= tree[to].low && tree[to].low <= tree[next].high) {
+
+                return true;
+            }
+
+            if(mayReach(next, to)) {
+
+                stack.push_back(next);
+            }
+        }
+    }
+
+    return false;
+}
+
+} // namespace granky
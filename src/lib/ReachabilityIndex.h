@@ -0,0 +1,94 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_REACHABILITYINDEX_H
+#define GRANKY_LIB_REACHABILITYINDEX_H
+
+#include <cstdint> // uint32_t
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * An index answering "can one node reach another along egresses".
+ *
+ * Build condenses strongly connected components into a DAG, then labels each
+ * component with:
+ * * its position in topological order, which rejects any backward query;
+ * * the pre and post order of one DFS spanning tree, which accepts tree descendants;
+ * * GRAIL intervals from a number of randomised traversals, which reject
+ *   most other unreachable pairs.
+ * Anything left undecided falls back to a DFS of the condensation that is
+ * pruned by the same labels.
+ *
+ * The index only describes the graph as it was when build was called.
+ * canReach reuses internal scratch space, so one index must not be queried
+ * from several threads at once.
+ */
+class ReachabilityIndex {
+
+public:
+    static constexpr const size_t DEFAULT_LABEL_COUNT = 3;
+
+    void build(const Graph& graph, const size_t labels = DEFAULT_LABEL_COUNT, const unsigned seed = 0);
+    bool canReach(const Graph::Node from, const Graph::Node to) const;
+
+    Graph::Node getComponent(const Graph::Node node) const;
+    Graph::Node getComponentCount() const;
+
+    /**
+     * The number of bytes held by the index, including scratch space.
+     */
+    size_t getFootprint() const;
+
+    /**
+     * The number of canReach calls that needed the fallback search.
+     */
+    size_t getFallbackCount() const;
+
+private:
+    struct Interval {
+
+        uint32_t low;
+        uint32_t high;
+    };
+
+    size_t labelCount = 0;
+    std::vector<Graph::Node> component;
+    std::vector<size_t> offset;
+    std::vector<Graph::Node> child;
+    std::vector<Interval> tree;
+    std::vector<Interval> label;
+
+    mutable std::vector<uint32_t> stamp;
+    mutable std::vector<Graph::Node> stack;
+    mutable uint32_t epoch = 0;
+    mutable size_t fallbacks = 0;
+
+    bool mayReach(const Graph::Node from, const Graph::Node to) const;
+    bool search(const Graph::Node from, const Graph::Node to) const;
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_REACHABILITYINDEX_H
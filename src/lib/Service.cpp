@@ -0,0 +1,414 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm> // nth_element, max_element
+#include <chrono>
+#include <cstring> // memcpy
+#include <future>
+
+#include "ComponentTracker.h"
+#include "PathQuery.h"
+#include "Service.h"
+#include "Trace.h"
+
+namespace granky {
+
+static constexpr const uint32_t RESPONSE_HEADER_BYTES = 10;
+static constexpr const uint32_t RESULT_BYTES = 16;
+
+namespace {
+
+template<class VALUE>
+void put(std::string& output, const VALUE value) {
+
+    output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<class VALUE>
+VALUE get(const char*& input) {
+
+    VALUE ret;
+    memcpy(&ret, input, sizeof(ret));
+    input += sizeof(ret);
+    return ret;
+}
+
+} // namespace
+
+Service::Service(Graph& graph, const unsigned threads) : graph(graph) {
+
+    GRANKY_TRACE("Service::Service");
+
+    if(threads != 1) {
+
+        executor.reset(new Executor(threads));
+    }
+
+    // components are found once, as the graph does not change
+    ComponentTracker tracker;
+    tracker.init(&graph);
+    tracker.execute();
+
+    const auto table = tracker.yieldTable();
+    labels.assign(std::max<Graph::Node>(graph.getEndNode(), 0), -1);
+    sizes.assign(tracker.getComponentCount(), 0);
+
+    for(Graph::Node node = 0; node < static_cast<Graph::Node>(labels.size()); ++node) {
+
+        if(graph.haveNode(node)) {
+
+            labels[node] = table->get(node);
+
+            if(labels[node] >= static_cast<Graph::Node>(sizes.size())) {
+
+                sizes.resize(labels[node] + 1, 0);
+            }
+
+            ++sizes[labels[node]];
+        }
+    }
+}
+
+Service::Response Service::answer(const Request& request) const {
+
+    Response ret;
+    ret.id = request.id;
+    ret.op = request.op;
+
+    const auto known = [this](const int64_t node) {
+
+        return node >= 0 && node < graph.getEndNode() && graph.haveNode(static_cast<Graph::Node>(node));
+    };
+
+    const auto a = static_cast<Graph::Node>(request.a);
+    const auto b = static_cast<Graph::Node>(request.b);
+
+    switch(request.op) {
+
+    case PING:
+        break;
+
+    case BFS: {
+
+        if(!known(request.a) || !known(request.b)) {
+
+            ret.status = UNKNOWN_NODE;
+            break;
+        }
+
+        // hops are kept in a table from the worker's own pool, and the search stops at the sink
+        auto hops = graph.getBlankNodeTally();
+        std::vector<Graph::Node> frontier(1, a);
+        std::vector<Graph::Node> next;
+        Graph::Node depth = 0;
+        Graph::Node found = a == b ? 0 : -1;
+        hops->set(a, 0);
+
+        const Graph::ProgressCall visit = [&](Graph::Node node, Graph::Weight) -> Graph::Node {
+
+            if(Graph::isNode(hops->get(node))) {
+
+                return -1;
+            }
+
+            hops->set(node, depth + 1);
+            next.push_back(node);
+            return node == b ? node : -1;
+        };
+
+        while(!frontier.empty() && !Graph::isNode(found)) {
+
+            next.clear();
+
+            for(const auto node : frontier) {
+
+                if(Graph::isNode(graph.forEachEgress(node, visit))) {
+
+                    found = depth + 1;
+                    break;
+                }
+            }
+
+            frontier.swap(next);
+            ++depth;
+        }
+
+        ret.results.push_back({b, found});
+        break;
+    }
+
+    case PATH: {
+
+        if(!known(request.a) || !known(request.b)) {
+
+            ret.status = UNKNOWN_NODE;
+            break;
+        }
+
+        AStar<ZeroHeuristic> search;
+        search.init(&graph);
+        search.setSource(a);
+        search.setSink(b);
+        search.execute();
+
+        if(!Graph::isWeight(search.yieldWeight())) {
+
+            break;
+        }
+
+        double distance = 0.0;
+        ret.results.push_back({a, distance});
+
+        for(const auto& each : search.yieldSequence()) {
+
+            distance += each.weight;
+            ret.results.push_back({each.to, distance});
+        }
+
+        break;
+    }
+
+    case COMPONENT:
+
+        if(!known(request.a) || static_cast<size_t>(request.a) >= labels.size()) {
+
+            ret.status = UNKNOWN_NODE;
+            break;
+        }
+
+        ret.results.push_back({labels[a], sizes[labels[a]]});
+        break;
+
+    case NEIGHBOURS:
+
+        if(!known(request.a)) {
+
+            ret.status = UNKNOWN_NODE;
+            break;
+        }
+
+        graph.forEachEgress(a, [&ret](Graph::Node to, Graph::Weight weight) {
+
+            ret.results.push_back({to, weight});
+            return -1;
+        });
+
+        break;
+
+    case STATS: {
+
+        const auto stats = getStats();
+        ret.results = {{0, stats.requests}, {1, stats.batches}, {2, stats.median}, {3, stats.p90},
+                {4, stats.p99}, {5, stats.max}, {6, graph.getNodeCount()}, {7, graph.getEdgeCount()}};
+        break;
+    }
+
+    default:
+        ret.status = UNKNOWN_OP;
+    }
+
+    return ret;
+}
+
+bool Service::serve(std::string& input, std::string& output) {
+
+    GRANKY_TRACE("Service::serve");
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Request> batch;
+    size_t taken = 0;
+
+    while(input.size() - taken >= sizeof(uint32_t)) {
+
+        const char* cursor = input.data() + taken;
+
+        if(get<uint32_t>(cursor) != REQUEST_BYTES) {
+
+            return false;
+        }
+
+        if(input.size() - taken < sizeof(uint32_t) + REQUEST_BYTES) {
+
+            break;
+        }
+
+        Request request;
+        request.op = get<uint8_t>(cursor);
+        request.id = get<uint32_t>(cursor);
+        request.a = get<int64_t>(cursor);
+        request.b = get<int64_t>(cursor);
+        batch.push_back(request);
+        taken += sizeof(uint32_t) + REQUEST_BYTES;
+    }
+
+    input.erase(0, taken);
+
+    if(batch.empty()) {
+
+        return true;
+    }
+
+    std::vector<Response> responses(batch.size());
+    std::vector<double> finished(batch.size());
+
+    const auto run = [&](const size_t i) {
+
+        responses[i] = answer(batch[i]);
+        finished[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    if(executor && batch.size() > 1) {
+
+        std::vector<std::future<void>> futures;
+
+        for(size_t i = 0; i < batch.size(); ++i) {
+
+            futures.push_back(executor->submit([&run, i]() { run(i); }));
+        }
+
+        for(auto& each : futures) {
+
+            each.wait();
+        }
+    }
+    else {
+
+        for(size_t i = 0; i < batch.size(); ++i) {
+
+            run(i);
+        }
+    }
+
+    for(const auto& each : responses) {
+
+        writeResponse(output, each);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    requests += batch.size();
+    ++batches;
+
+    for(const auto each : finished) {
+
+        if(latencies.size() < LATENCY_SAMPLES) {
+
+            latencies.push_back(each);
+        }
+        else {
+
+            latencies[nextLatency] = each;
+        }
+
+        nextLatency = (nextLatency + 1) % LATENCY_SAMPLES;
+    }
+
+    return true;
+}
+
+Service::Stats Service::getStats() const {
+
+    Stats ret;
+    std::vector<double> sorted;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ret.requests = requests;
+        ret.batches = batches;
+        sorted = latencies;
+    }
+
+    if(sorted.empty()) {
+
+        return ret;
+    }
+
+    const auto percentile = [&sorted](const double fraction) {
+
+        const auto at = sorted.begin() + static_cast<size_t>(fraction * (sorted.size() - 1));
+        std::nth_element(sorted.begin(), at, sorted.end());
+        return *at;
+    };
+
+    ret.median = percentile(0.5);
+    ret.p90 = percentile(0.9);
+    ret.p99 = percentile(0.99);
+    ret.max = *std::max_element(sorted.begin(), sorted.end());
+    return ret;
+}
+
+void Service::writeRequest(std::string& output, const Request& request) {
+
+    put<uint32_t>(output, REQUEST_BYTES);
+    put<uint8_t>(output, request.op);
+    put<uint32_t>(output, request.id);
+    put<int64_t>(output, request.a);
+    put<int64_t>(output, request.b);
+}
+
+void Service::writeResponse(std::string& output, const Response& response) {
+
+    put<uint32_t>(output, RESPONSE_HEADER_BYTES + RESULT_BYTES * response.results.size());
+    put<uint32_t>(output, response.id);
+    put<uint8_t>(output, response.op);
+    put<uint8_t>(output, response.status);
+    put<uint32_t>(output, response.results.size());
+
+    for(const auto& [node, value] : response.results) {
+
+        put<int64_t>(output, node);
+        put<double>(output, value);
+    }
+}
+
+bool Service::readResponse(std::string& input, Response& response) {
+
+    if(input.size() < sizeof(uint32_t) + RESPONSE_HEADER_BYTES) {
+
+        return false;
+    }
+
+    const char* cursor = input.data();
+    const auto length = get<uint32_t>(cursor);
+
+    if(input.size() < sizeof(uint32_t) + length) {
+
+        return false;
+    }
+
+    response.id = get<uint32_t>(cursor);
+    response.op = get<uint8_t>(cursor);
+    response.status = get<uint8_t>(cursor);
+
+    // a count the frame cannot hold is read as none
+    const auto count = get<uint32_t>(cursor);
+    response.results.resize(static_cast<uint64_t>(count) * RESULT_BYTES + RESPONSE_HEADER_BYTES == length ? count : 0);
+
+    for(auto& [node, value] : response.results) {
+
+        node = get<int64_t>(cursor);
+        value = get<double>(cursor);
+    }
+
+    input.erase(0, sizeof(uint32_t) + length);
+    return true;
+}
+
+} // namespace granky
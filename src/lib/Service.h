@@ -0,0 +1,158 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_SERVICE_H
+#define GRANKY_LIB_SERVICE_H
+
+#include <cstdint> // uint8_t, uint32_t, int64_t, uint64_t
+#include <memory> // unique_ptr
+#include <mutex>
+#include <string>
+#include <utility> // pair
+#include <vector>
+
+#include "Executor.h"
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * Answers queries about one resident graph in a compact binary protocol, so that
+ * a server can load a graph once and serve it to many short-lived clients.
+ *
+ * Every request is a frame of a 32 bit length, then an operation byte, a 32 bit
+ * ID chosen by the client and two 64 bit node arguments. Every response is a
+ * frame of a 32 bit length, the request's ID, its operation, a status byte and
+ * a 32 bit count of results, then each result as a 64 bit node and a 64 bit
+ * floating point value. Numbers are in the host's byte order, as the protocol
+ * is meant for local sockets.
+ *
+ * Clients may send any number of requests without waiting for responses. serve
+ * takes every whole request waiting in a buffer as one batch, spreads the batch
+ * over an Executor, and answers the requests in the order they came.
+ *
+ * Results by operation:
+ * * PING: none.
+ * * BFS (source, sink): (sink, hops), with hops of -1 if the sink is unreachable.
+ * * PATH (source, sink): (node, distance so far) for each node of a shortest
+ *   path, from (source, 0) to (sink, distance), or none if the sink is unreachable.
+ * * COMPONENT (node): (label, size), where nodes share a label if and only if
+ *   they share a component, taking edges in both directions.
+ * * NEIGHBOURS (node): (egress, weight) for every egress.
+ * * STATS: (0, requests), (1, batches), (2, median), (3, 90th percentile),
+ *   (4, 99th percentile) and (5, greatest) latency in microseconds, (6, nodes), (7, edges).
+ *
+ * The graph must not change while it is being served.
+ */
+class Service {
+
+public:
+    enum Op : uint8_t {
+
+        PING = 0,
+        BFS = 1,
+        PATH = 2,
+        COMPONENT = 3,
+        NEIGHBOURS = 4,
+        STATS = 5,
+    };
+
+    enum Status : uint8_t {
+
+        OK = 0,
+        UNKNOWN_OP = 1,
+        UNKNOWN_NODE = 2,
+    };
+
+    struct Request {
+
+        uint32_t id = 0;
+        uint8_t op = PING;
+        int64_t a = -1;
+        int64_t b = -1;
+    };
+
+    struct Response {
+
+        uint32_t id = 0;
+        uint8_t op = PING;
+        uint8_t status = OK;
+        std::vector<std::pair<int64_t, double>> results;
+    };
+
+    /**
+     * What the service has answered. Latencies run from a request's batch
+     * arriving to its response being ready, over the last LATENCY_SAMPLES.
+     */
+    struct Stats {
+
+        uint64_t requests = 0;
+        uint64_t batches = 0;
+        double median = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    static constexpr const uint32_t REQUEST_BYTES = 21;
+    static constexpr const size_t LATENCY_SAMPLES = 1 << 16;
+
+    /**
+     * Threads is the Executor's; one answers every request on the calling thread.
+     */
+    explicit Service(Graph& graph, const unsigned threads = 0);
+    Service(const Service&) = delete;
+    Service& operator=(const Service&) = delete;
+
+    /**
+     * Takes every whole request frame from the front of input, and appends a
+     * response frame to output for each. Returns false, having taken nothing,
+     * if the next frame is malformed, after which the client should be dropped.
+     */
+    bool serve(std::string& input, std::string& output);
+
+    Response answer(const Request& request) const;
+    Stats getStats() const;
+
+    static void writeRequest(std::string& output, const Request& request);
+    static void writeResponse(std::string& output, const Response& response);
+
+    /**
+     * Takes one whole response frame from the front of input, returning false
+     * if there is none yet.
+     */
+    static bool readResponse(std::string& input, Response& response);
+
+private:
+    Graph& graph;
+    std::unique_ptr<Executor> executor;
+    std::vector<Graph::Node> labels;
+    std::vector<Graph::Node> sizes;
+    mutable std::mutex mutex;
+    std::vector<double> latencies;
+    size_t nextLatency = 0;
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_SERVICE_H
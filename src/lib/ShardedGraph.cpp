@@ -0,0 +1,476 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm> // max
+#include <cassert>
+
+#include "ShardedGraph.h"
+
+namespace granky {
+
+/**
+ * splitmix64 finaliser, so that runs of consecutive IDs spread over every shard
+ */
+static inline uint64_t mix(uint64_t x) {
+
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+uint32_t ShardedGraph::Shard::insert(const Node node, bool& added) {
+
+    const auto found = slots.try_emplace(node, static_cast<uint32_t>(nodes.size()));
+    added = found.second;
+
+    if(added) {
+
+        nodes.push_back(node);
+        egress.emplace_back();
+        ingress.emplace_back();
+        changes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return found.first->second;
+}
+
+const ShardedGraph::Adjacency* ShardedGraph::Shard::find(const Node node, const bool forward) const {
+
+    const auto found = slots.find(node);
+
+    if(found == slots.end()) {
+
+        return nullptr;
+    }
+
+    return forward ? &egress[found->second] : &ingress[found->second];
+}
+
+/**
+ * the smallest power of two no lower than count
+ */
+static inline size_t roundUp(const size_t count) {
+
+    size_t ret = 1;
+
+    while(ret < count) {
+
+        ret <<= 1;
+    }
+
+    return ret;
+}
+
+ShardedGraph::ShardedGraph(const size_t count) : Graph(), mask(roundUp(count) - 1), version(drawVersion()) {
+
+    shards.reset(new Shard[mask + 1]);
+}
+
+ShardedGraph::Shard& ShardedGraph::getShard(const Node node) const {
+
+    return shards[mix(static_cast<uint64_t>(node)) & mask];
+}
+
+int64_t ShardedGraph::Index::find(const Node node, const Node other) const {
+
+    if(slots.empty()) {
+
+        return -1;
+    }
+
+    const auto last = slots.size() - 1;
+
+    for(auto i = mix(mix(static_cast<uint64_t>(node)) ^ static_cast<uint64_t>(other)) & last;; i = (i + 1) & last) {
+
+        if(!isNode(slots[i].node)) {
+
+            return -1;
+        }
+
+        if(slots[i].node == node && slots[i].other == other) {
+
+            return slots[i].at;
+        }
+    }
+}
+
+void ShardedGraph::Index::put(const Node node, const Node other, const uint32_t at) {
+
+    // kept at most three quarters full, and a power of two in size
+    if((used + 1) * 4 > slots.size() * 3) {
+
+        std::vector<Slot> old(std::max<size_t>(slots.size() * 2, 64), Slot{-1, -1, 0});
+        old.swap(slots);
+        used = 0;
+
+        for(const auto& each : old) {
+
+            if(isNode(each.node)) {
+
+                put(each.node, each.other, each.at);
+            }
+        }
+    }
+
+    const auto last = slots.size() - 1;
+    auto i = mix(mix(static_cast<uint64_t>(node)) ^ static_cast<uint64_t>(other)) & last;
+
+    while(isNode(slots[i].node)) {
+
+        i = (i + 1) & last;
+    }
+
+    slots[i] = {node, other, at};
+    ++used;
+}
+
+int64_t ShardedGraph::locate(const Adjacency& list, const Index& index, const Node node, const Node other) {
+
+    if(list.size() > SCAN_LIMIT) {
+
+        return index.find(node, other);
+    }
+
+    for(size_t i = 0; i < list.size(); ++i) {
+
+        if(list[i].first == other) {
+
+            return static_cast<int64_t>(i);
+        }
+    }
+
+    return -1;
+}
+
+Graph::Weight ShardedGraph::store(Adjacency& list, Index& index, const Node node, const Node other, const Weight weight) {
+
+    if(const auto at = locate(list, index, node, other); at >= 0) {
+
+        const auto ret = list[at].second;
+        list[at].second = weight;
+        return ret;
+    }
+
+    list.emplace_back(other, weight);
+
+    // an adjacency outgrowing a scan is indexed whole
+    if(list.size() == SCAN_LIMIT + 1) {
+
+        for(size_t i = 0; i < list.size(); ++i) {
+
+            index.put(node, list[i].first, static_cast<uint32_t>(i));
+        }
+    }
+    else if(list.size() > SCAN_LIMIT + 1) {
+
+        index.put(node, other, static_cast<uint32_t>(list.size() - 1));
+    }
+
+    return NO_WEIGHT;
+}
+
+void ShardedGraph::noteAdded(const Node node) {
+
+    auto end = endNode.load(std::memory_order_relaxed);
+
+    while(end <= node && !endNode.compare_exchange_weak(end, node + 1, std::memory_order_relaxed));
+
+    notifyNode(node);
+}
+
+Graph::EdgeList ShardedGraph::getEdges() const {
+
+    EdgeList ret;
+    ret.reserve(getEdgeCount());
+
+    const NodeCall nodeCall = [this, &ret](Node from) {
+
+        for(const auto& each : *getShard(from).find(from, true)) {
+
+            ret.push_back({from, each.first, each.second});
+        }
+
+        return -1;
+    };
+
+    forEachNode(nodeCall);
+    return ret;
+}
+
+bool ShardedGraph::haveNode(const Node node) const {
+
+    return isNode(node) && getShard(node).slots.count(node);
+}
+
+Graph::Weight ShardedGraph::getWeight(const Node from, const Node to) const {
+
+    if(!isNode(from) || !isNode(to)) {
+
+        return NO_WEIGHT;
+    }
+
+    const auto& shard = getShard(from);
+    const auto egress = shard.find(from, true);
+    const auto at = egress ? locate(*egress, shard.egressIndex, from, to) : -1;
+
+    return at >= 0 ? (*egress)[at].second : NO_WEIGHT;
+}
+
+void ShardedGraph::addNode(const Node node) {
+
+    assert(isNode(node));
+    auto& shard = getShard(node);
+    bool added = false;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.insert(node, added);
+    }
+
+    if(added) {
+
+        noteAdded(node);
+    }
+}
+
+void ShardedGraph::addEdge(const Node from, const Node to, const Weight weight) {
+
+    assert(isNode(from) && isNode(to) && isWeight(weight));
+
+    Weight previous = NO_WEIGHT;
+    bool fromAdded = false;
+    bool toAdded = false;
+
+    auto& tail = getShard(from);
+    auto& head = getShard(to);
+
+    {
+        // both ends under both locks, so that racing writers of one edge leave its two copies agreeing
+        std::unique_lock<std::mutex> tailLock(tail.mutex, std::defer_lock);
+        std::unique_lock<std::mutex> headLock(head.mutex, std::defer_lock);
+
+        if(&tail == &head) {
+
+            tailLock.lock();
+        }
+        else {
+
+            std::lock(tailLock, headLock);
+        }
+
+        previous = store(tail.egress[tail.insert(from, fromAdded)], tail.egressIndex, from, to, weight);
+
+        // the fingerprint and edge count follow the rules noteEdge keeps for other backends
+        if(from != to) {
+
+            auto delta = hashEdge(from, to, weight);
+
+            if(isWeight(previous)) {
+
+                delta -= hashEdge(from, to, previous);
+            }
+            else {
+
+                tail.edgeCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            tail.fingerprint.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        tail.changes.fetch_add(1, std::memory_order_relaxed);
+
+        store(head.ingress[head.insert(to, toAdded)], head.ingressIndex, to, from, weight);
+    }
+
+    if(fromAdded) {
+
+        noteAdded(from);
+    }
+
+    if(toAdded) {
+
+        noteAdded(to);
+    }
+
+    notifyEdge(from, to, previous, weight);
+}
+
+Graph::Node ShardedGraph::getNodeCount() const {
+
+    Node ret = 0;
+
+    for(size_t i = 0; i <= mask; ++i) {
+
+        ret += static_cast<Node>(shards[i].nodes.size());
+    }
+
+    return ret;
+}
+
+Graph::Node ShardedGraph::getEndNode() const {
+
+    return endNode.load(std::memory_order_relaxed);
+}
+
+Graph::Node ShardedGraph::forEachNode(const NodeCall& callback) const {
+
+    Node ret = -1;
+
+    for(size_t i = 0; i <= mask; ++i) {
+
+        for(const auto node : shards[i].nodes) {
+
+            if(ret = callback(node); isNode(ret)) {
+
+                return ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node ShardedGraph::forEachEgress(const Node from, const ProgressCall& callback) const {
+
+    const auto egress = isNode(from) ? getShard(from).find(from, true) : nullptr;
+
+    if(!egress) {
+
+        return -1;
+    }
+
+    Node ret = -1;
+
+    for(const auto& each : *egress) {
+
+        if(ret = callback(each.first, each.second); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node ShardedGraph::forEachIngress(const Node to, const ProgressCall& callback) const {
+
+    const auto ingress = isNode(to) ? getShard(to).find(to, false) : nullptr;
+
+    if(!ingress) {
+
+        return -1;
+    }
+
+    Node ret = -1;
+
+    for(const auto& each : *ingress) {
+
+        if(ret = callback(each.first, each.second); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node ShardedGraph::forEachLightDigress(const Node from, const ProgressCall& callback) const {
+
+    if(!haveNode(from)) {
+
+        return -1;
+    }
+
+    Node ret = -1;
+    const auto& shard = getShard(from);
+    const auto& egress = *shard.find(from, true);
+
+    for(const auto& each : egress) {
+
+        if(ret = callback(each.first, getLightDigress(from, each.first)); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    // ingresses from nodes that are also egresses were already covered above
+    for(const auto& each : *shard.find(from, false)) {
+
+        if(locate(egress, shard.egressIndex, from, each.first) >= 0) {
+
+            continue;
+        }
+
+        if(ret = callback(each.first, each.second); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+Graph::Version ShardedGraph::getVersion() const {
+
+    uint64_t changes = 0;
+
+    for(size_t i = 0; i <= mask; ++i) {
+
+        changes += shards[i].changes.load(std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(versionMutex);
+
+    if(changes != versionChanges) {
+
+        versionChanges = changes;
+        version = drawVersion();
+    }
+
+    return version;
+}
+
+uint64_t ShardedGraph::getFingerprint() const {
+
+    uint64_t ret = 0;
+
+    for(size_t i = 0; i <= mask; ++i) {
+
+        ret += shards[i].fingerprint.load(std::memory_order_relaxed);
+    }
+
+    return ret;
+}
+
+size_t ShardedGraph::getEdgeCount() const {
+
+    size_t ret = 0;
+
+    for(size_t i = 0; i <= mask; ++i) {
+
+        ret += shards[i].edgeCount.load(std::memory_order_relaxed);
+    }
+
+    return ret;
+}
+
+} // namespace granky
@@ -0,0 +1,153 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_SHARDEDGRAPH_H
+#define GRANKY_LIB_SHARDEDGRAPH_H
+
+#include <atomic>
+#include <cstdint> // uint32_t, uint64_t
+#include <memory> // unique_ptr
+#include <mutex>
+#include <unordered_map>
+#include <utility> // pair
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * A hash-based backend that many threads may add nodes and edges to at once.
+ *
+ * Nodes are spread over shards by a hash of their ID, and each shard has a
+ * lock of its own, so writers only contend when they touch the same shard.
+ * A node's egresses and ingresses are flat vectors of neighbours, scanned to
+ * find an edge again while short, and indexed in a per-shard open addressing
+ * table once long, rather than a map per node.
+ *
+ * An edge is written under the locks of both its tail's and its head's shards,
+ * taken together, so its egress and ingress always agree. Reads take no locks,
+ * and so must not overlap writes.
+ * Observers are told of changes from the writing threads, possibly at once.
+ */
+class ShardedGraph : public Graph {
+
+public:
+    static constexpr const size_t DEFAULT_SHARDS = 64;
+
+    /**
+     * The shard count is rounded up to a power of two.
+     */
+    explicit ShardedGraph(const size_t shards = DEFAULT_SHARDS);
+    ShardedGraph(const ShardedGraph&) = delete;
+    ShardedGraph& operator=(const ShardedGraph&) = delete;
+
+    virtual EdgeList getEdges() const override;
+    virtual bool haveNode(const Node node) const override;
+    virtual Weight getWeight(const Node from, const Node to) const override;
+    virtual void addNode(const Node node) override;
+    virtual void addEdge(const Node from, const Node to, const Weight weight) override;
+    virtual Node getNodeCount() const override;
+    virtual Node getEndNode() const override;
+
+    virtual Node forEachNode(const NodeCall& callback) const override;
+    virtual Node forEachEgress(Node node, const ProgressCall& callback) const override;
+    virtual Node forEachIngress(Node node, const ProgressCall& callback) const override;
+    virtual Node forEachLightDigress(Node node, const ProgressCall& callback) const override;
+
+    /**
+     * Summed over the shards. A new version is drawn whenever a shard has changed since the last call.
+     */
+    virtual Version getVersion() const override;
+    virtual uint64_t getFingerprint() const override;
+    virtual size_t getEdgeCount() const override;
+
+private:
+    typedef std::vector<std::pair<Node, Weight>> Adjacency;
+
+    /**
+     * Adjacencies of up to SCAN_LIMIT neighbours are scanned to find an edge.
+     * Beyond that, the node's edges are also kept in its shard's index.
+     */
+    static constexpr const size_t SCAN_LIMIT = 16;
+
+    /**
+     * The positions of edges in their adjacencies, by both ends, in one open
+     * addressing table per shard and direction. Edges are never removed.
+     */
+    struct Index {
+
+        struct Slot {
+
+            Node node;
+            Node other;
+            uint32_t at;
+        };
+
+        std::vector<Slot> slots;
+        size_t used = 0;
+
+        int64_t find(const Node node, const Node other) const;
+        void put(const Node node, const Node other, const uint32_t at);
+    };
+
+    struct alignas(64) Shard {
+
+        std::mutex mutex;
+        std::unordered_map<Node, uint32_t> slots;
+        std::vector<Node> nodes;
+        std::vector<Adjacency> egress;
+        std::vector<Adjacency> ingress;
+        Index egressIndex;
+        Index ingressIndex;
+
+        std::atomic<uint64_t> fingerprint{0};
+        std::atomic<size_t> edgeCount{0};
+        std::atomic<uint64_t> changes{0};
+
+        uint32_t insert(const Node node, bool& added);
+        const Adjacency* find(const Node node, const bool forward) const;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    const size_t mask;
+    std::atomic<Node> endNode{0};
+    mutable std::mutex versionMutex;
+    mutable uint64_t versionChanges = 0;
+    mutable Version version;
+
+    Shard& getShard(const Node node) const;
+
+    /**
+     * The position of other in node's adjacency, or -1.
+     */
+    static int64_t locate(const Adjacency& list, const Index& index, const Node node, const Node other);
+
+    /**
+     * Adds or reweights the edge to other in node's adjacency, returning its previous weight.
+     */
+    static Weight store(Adjacency& list, Index& index, const Node node, const Node other, const Weight weight);
+    void noteAdded(const Node node);
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_SHARDEDGRAPH_H
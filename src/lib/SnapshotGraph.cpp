@@ -0,0 +1,439 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+
+#include <algorithm> // min, max, lower_bound, remove_if
+#include <thread> // yield
+
+#include "SnapshotGraph.h"
+#include "Trace.h"
+
+namespace granky {
+
+SnapshotGraph::Snapshot::Snapshot(const Snapshot& other, const Graph& state) :
+    Graph(), blocks(other.blocks), endNode(other.endNode), nodeCount(other.nodeCount) {
+
+    copyState(state);
+}
+
+Graph::EdgeList SnapshotGraph::Snapshot::getEdges() const {
+
+    EdgeList ret;
+    ret.reserve(getEdgeCount());
+
+    const NodeCall nodeCall = [this, &ret](Node from) {
+
+        for(const auto& each : getBlock(from)->egress[from % BLOCK_NODES]) {
+
+            ret.push_back({from, each.first, each.second});
+        }
+
+        return -1;
+    };
+
+    forEachNode(nodeCall);
+    return ret;
+}
+
+bool SnapshotGraph::Snapshot::haveNode(const Node node) const {
+
+    const auto block = getBlock(node);
+    return block && (block->present >> (node % BLOCK_NODES)) & 1;
+}
+
+Graph::Weight SnapshotGraph::Snapshot::getWeight(const Node from, const Node to) const {
+
+    if(!haveNode(from)) {
+
+        return NO_WEIGHT;
+    }
+
+    const auto& egress = getBlock(from)->egress[from % BLOCK_NODES];
+    const auto found = find(egress, to);
+    return found == egress.end() ? NO_WEIGHT : found->second;
+}
+
+void SnapshotGraph::Snapshot::addNode(const Node) {
+
+    assert(!"snapshots are read only");
+}
+
+void SnapshotGraph::Snapshot::addEdge(const Node, const Node, const Weight) {
+
+    assert(!"snapshots are read only");
+}
+
+Graph::Node SnapshotGraph::Snapshot::getNodeCount() const {
+
+    return nodeCount;
+}
+
+Graph::Node SnapshotGraph::Snapshot::getEndNode() const {
+
+    return endNode;
+}
+
+Graph::Node SnapshotGraph::Snapshot::forEachNode(const NodeCall& callback) const {
+
+    Node ret = -1;
+
+    for(size_t i = 0; i < blocks.size(); ++i) {
+
+        if(!blocks[i]) {
+
+            continue;
+        }
+
+        for(auto present = blocks[i]->present; present; present &= present - 1) {
+
+            const auto node = static_cast<Node>(i * BLOCK_NODES + __builtin_ctzll(present));
+
+            if(ret = callback(node); isNode(ret)) {
+
+                return ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node SnapshotGraph::Snapshot::forEachEgress(const Node from, const ProgressCall& callback) const {
+
+    if(!haveNode(from)) {
+
+        return -1;
+    }
+
+    Node ret = -1;
+
+    for(const auto& each : getBlock(from)->egress[from % BLOCK_NODES]) {
+
+        if(ret = callback(each.first, each.second); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node SnapshotGraph::Snapshot::forEachIngress(const Node to, const ProgressCall& callback) const {
+
+    if(!haveNode(to)) {
+
+        return -1;
+    }
+
+    Node ret = -1;
+
+    for(const auto& each : getBlock(to)->ingress[to % BLOCK_NODES]) {
+
+        if(ret = callback(each.first, each.second); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+Graph::Node SnapshotGraph::Snapshot::forEachLightDigress(const Node from, const ProgressCall& callback) const {
+
+    if(!haveNode(from)) {
+
+        return -1;
+    }
+
+    Node ret = -1;
+    const auto block = getBlock(from);
+    const auto& exits = block->egress[from % BLOCK_NODES];
+
+    for(const auto& each : exits) {
+
+        if(ret = callback(each.first, getLightDigress(from, each.first)); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    // ingresses from nodes that are also egresses were already covered above
+    for(const auto& each : block->ingress[from % BLOCK_NODES]) {
+
+        if(find(exits, each.first) != exits.end()) {
+
+            continue;
+        }
+
+        if(ret = callback(each.first, each.second); isNode(ret)) {
+
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+const SnapshotGraph::Snapshot::Block* SnapshotGraph::Snapshot::getBlock(const Node node) const {
+
+    const auto index = static_cast<size_t>(node / BLOCK_NODES);
+    return isNode(node) && index < blocks.size() ? blocks[index].get() : nullptr;
+}
+
+SnapshotGraph::Snapshot::Block& SnapshotGraph::Snapshot::getWritable(const Node node) {
+
+    const auto index = static_cast<size_t>(node / BLOCK_NODES);
+
+    if(index >= blocks.size()) {
+
+        blocks.resize(index + 1);
+    }
+
+    auto& block = blocks[index];
+
+    // only the writer counts references, so a block no snapshot shares is the draft's alone
+    if(!block) {
+
+        block = std::make_shared<Block>();
+    }
+    else if(block.use_count() > 1) {
+
+        block = std::make_shared<Block>(*block);
+    }
+
+    return *block;
+}
+
+bool SnapshotGraph::Snapshot::insertNode(const Node node) {
+
+    assert(isNode(node));
+
+    if(haveNode(node)) {
+
+        return false;
+    }
+
+    getWritable(node).present |= uint64_t(1) << (node % BLOCK_NODES);
+    endNode = std::max(endNode, node + 1);
+    ++nodeCount;
+    return true;
+}
+
+void SnapshotGraph::Snapshot::insertEdge(const Node from, const Node to, const Weight weight) {
+
+    put(getWritable(from).egress[from % BLOCK_NODES], to, weight);
+    put(getWritable(to).ingress[to % BLOCK_NODES], from, weight);
+}
+
+SnapshotGraph::Snapshot::Adjacency::const_iterator SnapshotGraph::Snapshot::find(const Adjacency& adjacency, const Node node) {
+
+    const auto ret = std::lower_bound(adjacency.begin(), adjacency.end(), node, [](const std::pair<Node, Weight>& each, const Node n) {
+
+        return each.first < n;
+    });
+
+    return ret != adjacency.end() && ret->first == node ? ret : adjacency.end();
+}
+
+void SnapshotGraph::Snapshot::put(Adjacency& adjacency, const Node node, const Weight weight) {
+
+    const auto at = std::lower_bound(adjacency.begin(), adjacency.end(), node, [](const std::pair<Node, Weight>& each, const Node n) {
+
+        return each.first < n;
+    });
+
+    if(at != adjacency.end() && at->first == node) {
+
+        at->second = weight;
+    }
+    else {
+
+        adjacency.emplace(at, node, weight);
+    }
+}
+
+SnapshotGraph::Reader::Reader(const SnapshotGraph* o, const size_t s, Snapshot* snap) :
+    owner(o), slot(s), snapshot(snap) {}
+
+SnapshotGraph::Reader::Reader(Reader&& other) : owner(other.owner), slot(other.slot), snapshot(other.snapshot) {
+
+    other.owner = nullptr;
+}
+
+SnapshotGraph::Reader::~Reader() {
+
+    if(owner) {
+
+        owner->slots[slot].epoch.store(0);
+    }
+}
+
+SnapshotGraph::SnapshotGraph(const size_t i) : current(new Snapshot()), interval(std::max<size_t>(i, 1)) {}
+
+SnapshotGraph::~SnapshotGraph() {
+
+    delete current.load();
+
+    for(const auto& each : retired) {
+
+        delete each.first;
+    }
+}
+
+SnapshotGraph::Reader SnapshotGraph::read() const {
+
+    for(size_t i = 0;; i = (i + 1) % MAX_READERS) {
+
+        uint64_t idle = 0;
+
+        // the epoch is announced before the snapshot is loaded, so a writer that
+        // misses the announcement has already swapped in a newer snapshot
+        if(slots[i].epoch.compare_exchange_strong(idle, epoch.load())) {
+
+            return Reader(this, i, current.load());
+        }
+
+        if(i + 1 == MAX_READERS) {
+
+            std::this_thread::yield();
+        }
+    }
+}
+
+void SnapshotGraph::publish() {
+
+    GRANKY_TRACE("SnapshotGraph::publish");
+    const auto old = current.exchange(new Snapshot(draft, *this));
+
+    // readers announcing the new epoch or later can only have loaded the new snapshot
+    retired.emplace_back(old, epoch.fetch_add(1) + 1);
+    pending = 0;
+    reclaim();
+}
+
+void SnapshotGraph::reclaim() {
+
+    uint64_t oldest = UINT64_MAX;
+
+    for(const auto& each : slots) {
+
+        if(const auto announced = each.epoch.load(); announced) {
+
+            oldest = std::min(oldest, announced);
+        }
+    }
+
+    const auto last = std::remove_if(retired.begin(), retired.end(), [oldest](const std::pair<Snapshot*, uint64_t>& each) {
+
+        if(each.second <= oldest) {
+
+            delete each.first;
+            return true;
+        }
+
+        return false;
+    });
+
+    retired.erase(last, retired.end());
+}
+
+size_t SnapshotGraph::getRetiredCount() const {
+
+    return retired.size();
+}
+
+Graph::EdgeList SnapshotGraph::getEdges() const {
+
+    return draft.getEdges();
+}
+
+bool SnapshotGraph::haveNode(const Node node) const {
+
+    return draft.haveNode(node);
+}
+
+Graph::Weight SnapshotGraph::getWeight(const Node from, const Node to) const {
+
+    return draft.getWeight(from, to);
+}
+
+void SnapshotGraph::addNode(const Node node) {
+
+    if(draft.insertNode(node)) {
+
+        noteNode(node);
+
+        if(++pending >= interval) {
+
+            publish();
+        }
+    }
+}
+
+void SnapshotGraph::addEdge(const Node from, const Node to, const Weight weight) {
+
+    assert(isWeight(weight));
+
+    addNode(from);
+    addNode(to);
+
+    const auto previous = draft.getWeight(from, to);
+    draft.insertEdge(from, to, weight);
+    noteEdge(from, to, previous, weight);
+
+    if(++pending >= interval) {
+
+        publish();
+    }
+}
+
+Graph::Node SnapshotGraph::getNodeCount() const {
+
+    return draft.getNodeCount();
+}
+
+Graph::Node SnapshotGraph::getEndNode() const {
+
+    return draft.getEndNode();
+}
+
+Graph::Node SnapshotGraph::forEachNode(const NodeCall& callback) const {
+
+    return draft.forEachNode(callback);
+}
+
+Graph::Node SnapshotGraph::forEachEgress(const Node node, const ProgressCall& callback) const {
+
+    return draft.forEachEgress(node, callback);
+}
+
+Graph::Node SnapshotGraph::forEachIngress(const Node node, const ProgressCall& callback) const {
+
+    return draft.forEachIngress(node, callback);
+}
+
+Graph::Node SnapshotGraph::forEachLightDigress(const Node node, const ProgressCall& callback) const {
+
+    return draft.forEachLightDigress(node, callback);
+}
+
+} // namespace granky
@@ -0,0 +1,201 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_SNAPSHOTGRAPH_H
+#define GRANKY_LIB_SNAPSHOTGRAPH_H
+
+#include <array>
+#include <atomic>
+#include <cstdint> // uint64_t
+#include <memory> // shared_ptr
+#include <utility> // pair
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+/**
+ * A graph that one writer thread changes while any number of reader threads
+ * traverse consistent, immutable snapshots of it without taking a lock.
+ *
+ * Adjacency is kept in blocks of BLOCK_NODES nodes, shared between snapshots
+ * and copied on write: the first change to a block after a publish copies
+ * that block alone. publish makes every change so far visible to new readers
+ * by swapping in a new Snapshot, and runs automatically every interval changes.
+ *
+ * Readers announce the epoch they started in, and a retired snapshot is only
+ * deleted, by the writer, once no reader that might hold it remains. Readers
+ * never touch reference counts, so the blocks are only ever counted and freed
+ * by the writer.
+ *
+ * The SnapshotGraph itself is a Graph for its writer, who also sees changes
+ * not yet published. Readers must finish before the SnapshotGraph is destroyed.
+ */
+class SnapshotGraph : public Graph {
+
+public:
+    static constexpr const Node BLOCK_NODES = 64;
+    static constexpr const size_t MAX_READERS = 64;
+    static constexpr const size_t DEFAULT_INTERVAL = 1024;
+
+    /**
+     * An immutable view of the graph as of a publish. It is a Graph, so queries
+     * may run on it, but it may not be changed and observers may not attach.
+     */
+    class Snapshot : public Graph {
+
+        friend class SnapshotGraph;
+
+    public:
+        virtual EdgeList getEdges() const override;
+        virtual bool haveNode(const Node node) const override;
+        virtual Weight getWeight(const Node from, const Node to) const override;
+        virtual void addNode(const Node node) override;
+        virtual void addEdge(const Node from, const Node to, const Weight weight) override;
+        virtual Node getNodeCount() const override;
+        virtual Node getEndNode() const override;
+
+        virtual Node forEachNode(const NodeCall& callback) const override;
+        virtual Node forEachEgress(Node node, const ProgressCall& callback) const override;
+        virtual Node forEachIngress(Node node, const ProgressCall& callback) const override;
+        virtual Node forEachLightDigress(Node node, const ProgressCall& callback) const override;
+
+    private:
+        typedef std::vector<std::pair<Node, Weight>> Adjacency;
+
+        struct Block {
+
+            uint64_t present = 0;
+            std::array<Adjacency, BLOCK_NODES> egress;
+            std::array<Adjacency, BLOCK_NODES> ingress;
+        };
+
+        std::vector<std::shared_ptr<Block>> blocks;
+        Node endNode = 0;
+        Node nodeCount = 0;
+
+        Snapshot() = default;
+        Snapshot(const Snapshot& other, const Graph& state);
+
+        const Block* getBlock(const Node node) const;
+        Block& getWritable(const Node node);
+        bool insertNode(const Node node);
+        void insertEdge(const Node from, const Node to, const Weight weight);
+
+        /**
+         * Adjacencies are kept sorted by neighbour, and searched by bisection.
+         */
+        static Adjacency::const_iterator find(const Adjacency& adjacency, const Node node);
+        static void put(Adjacency& adjacency, const Node node, const Weight weight);
+    };
+
+    /**
+     * A reader's hold on the snapshot current when it was made. Cheap to make,
+     * and meant to be short lived, as it keeps that snapshot from being reclaimed.
+     */
+    class Reader {
+
+        friend class SnapshotGraph;
+
+    public:
+        Reader(Reader&& other);
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader();
+
+        inline Snapshot* get() const {
+
+            return snapshot;
+        }
+
+        inline Snapshot* operator->() const {
+
+            return snapshot;
+        }
+
+        inline Snapshot& operator*() const {
+
+            return *snapshot;
+        }
+
+    private:
+        const SnapshotGraph* owner;
+        size_t slot;
+        Snapshot* snapshot;
+
+        Reader(const SnapshotGraph* owner, const size_t slot, Snapshot* snapshot);
+    };
+
+    explicit SnapshotGraph(const size_t interval = DEFAULT_INTERVAL);
+    SnapshotGraph(const SnapshotGraph&) = delete;
+    SnapshotGraph& operator=(const SnapshotGraph&) = delete;
+    virtual ~SnapshotGraph();
+
+    /**
+     * Takes hold of the current snapshot. Safe from any thread, at any time.
+     * Waits only if MAX_READERS readers are already held.
+     */
+    Reader read() const;
+
+    /**
+     * Makes every change so far visible to new readers, and reclaims
+     * the snapshots no reader holds any longer. Writer only.
+     */
+    void publish();
+    void reclaim();
+
+    /**
+     * The number of old snapshots still waiting for their readers to finish.
+     */
+    size_t getRetiredCount() const;
+
+    virtual EdgeList getEdges() const override;
+    virtual bool haveNode(const Node node) const override;
+    virtual Weight getWeight(const Node from, const Node to) const override;
+    virtual void addNode(const Node node) override;
+    virtual void addEdge(const Node from, const Node to, const Weight weight) override;
+    virtual Node getNodeCount() const override;
+    virtual Node getEndNode() const override;
+
+    virtual Node forEachNode(const NodeCall& callback) const override;
+    virtual Node forEachEgress(Node node, const ProgressCall& callback) const override;
+    virtual Node forEachIngress(Node node, const ProgressCall& callback) const override;
+    virtual Node forEachLightDigress(Node node, const ProgressCall& callback) const override;
+
+private:
+    struct alignas(64) Slot {
+
+        std::atomic<uint64_t> epoch{0};
+    };
+
+    Snapshot draft;
+    std::atomic<Snapshot*> current;
+    std::atomic<uint64_t> epoch{1};
+    mutable std::array<Slot, MAX_READERS> slots;
+    std::vector<std::pair<Snapshot*, uint64_t>> retired;
+    const size_t interval;
+    size_t pending = 0;
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_SNAPSHOTGRAPH_H
@@ -0,0 +1,139 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm> // fill
+#include <new> // nothrow
+
+#include "TablePool.h"
+#include "Trace.h"
+
+namespace granky {
+
+EpochTally::EpochTally(const Graph::Node count) : values(count, -1), stamps(count, 0) {}
+
+Graph::Table::Instance EpochTally::clone() const {
+
+    // a copy belongs to no pool
+    auto ret = new(std::nothrow) EpochTally(*this);
+
+    if(ret) {
+
+        ret->home.reset();
+    }
+
+    return Graph::Table::Instance(ret);
+}
+
+void EpochTally::reset() {
+
+    // stamps only match the epoch they were set in, until it wraps around
+    if(++epoch == 0) {
+
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+    }
+}
+
+void EpochTally::reserve(const Graph::Node count) {
+
+    if(static_cast<size_t>(count) > values.size()) {
+
+        values.resize(count, -1);
+        stamps.resize(count, 0);
+    }
+}
+
+Graph::Node EpochTally::getSize() const {
+
+    return static_cast<Graph::Node>(values.size());
+}
+
+void EpochTally::release() {
+
+    if(const auto shelf = home.lock()) {
+
+        std::lock_guard<std::mutex> lock(shelf->mutex);
+
+        if(shelf->idle.size() < shelf->limit) {
+
+            shelf->idle.push_back(this);
+            return;
+        }
+    }
+
+    delete this;
+}
+
+EpochTally::Shelf::~Shelf() {
+
+    for(const auto each : idle) {
+
+        delete each;
+    }
+}
+
+TablePool::TablePool(const size_t limit) : shelf(std::make_shared<EpochTally::Shelf>()) {
+
+    shelf->limit = limit;
+}
+
+EpochTally::Instance TablePool::borrow(const Graph::Node count) {
+
+    EpochTally* ret = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(shelf->mutex);
+
+        if(!shelf->idle.empty()) {
+
+            ret = shelf->idle.back();
+            shelf->idle.pop_back();
+        }
+    }
+
+    if(ret) {
+
+        ret->reset();
+        ret->reserve(count);
+    }
+    else {
+
+        GRANKY_TRACE("TablePool::allocate");
+        ret = new EpochTally(count);
+        ret->home = shelf;
+    }
+
+    return EpochTally::Instance(ret);
+}
+
+size_t TablePool::getIdleCount() const {
+
+    std::lock_guard<std::mutex> lock(shelf->mutex);
+    return shelf->idle.size();
+}
+
+TablePool& TablePool::local() {
+
+    thread_local TablePool ret;
+    return ret;
+}
+
+} // namespace granky
@@ -0,0 +1,135 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_TABLEPOOL_H
+#define GRANKY_LIB_TABLEPOOL_H
+
+#include <cassert>
+#include <cstdint> // uint32_t
+#include <memory> // shared_ptr, weak_ptr
+#include <mutex>
+#include <vector>
+
+#include "Graph.h"
+
+namespace granky {
+
+class TablePool;
+
+/**
+ * A tally, unset entries being -1, that is cleared in constant time by
+ * advancing an epoch rather than by writing every entry.
+ *
+ * The class is final and its get and set are inline, so code holding an
+ * EpochTally itself, rather than a Table, calls them without virtual dispatch.
+ * It also serves wherever a NodeCheck would, as checks only ask isNode of get.
+ */
+class EpochTally final : public Graph::Table {
+
+    friend class TablePool;
+
+public:
+    typedef std::unique_ptr<EpochTally, Graph::Table::Release> Instance;
+
+    EpochTally(const Graph::Node count);
+
+    inline virtual Graph::Node get(const Graph::Node node) const override {
+
+        assert(Graph::isNode(node) && static_cast<size_t>(node) < values.size());
+        return stamps[node] == epoch ? values[node] : -1;
+    }
+
+    inline virtual void set(const Graph::Node node, const Graph::Node value) override {
+
+        assert(Graph::isNode(node) && static_cast<size_t>(node) < values.size());
+        stamps[node] = epoch;
+        values[node] = value;
+    }
+
+    virtual Graph::Table::Instance clone() const override;
+
+    /**
+     * Unsets every entry.
+     */
+    void reset();
+
+    /**
+     * Makes room for at least count nodes, keeping every entry.
+     */
+    void reserve(const Graph::Node count);
+
+    Graph::Node getSize() const;
+
+protected:
+    virtual void release() override;
+
+private:
+    struct Shelf;
+
+    std::vector<Graph::Node> values;
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 1;
+    std::weak_ptr<Shelf> home;
+};
+
+/**
+ * Lends out EpochTallies and takes them back, so that short queries reuse
+ * tables rather than allocating and filling new ones.
+ *
+ * A borrowed table is cleared and sized for the count asked for, and goes back
+ * to the pool when its Instance is destroyed, on any thread. If the pool has
+ * gone by then, the table is simply deleted. Every thread has a pool of its own
+ * in local, which Graph::getBlankNodeCheck and getBlankNodeTally borrow from.
+ */
+class TablePool {
+
+public:
+    TablePool(const size_t limit = DEFAULT_LIMIT);
+    TablePool(const TablePool&) = delete;
+    TablePool& operator=(const TablePool&) = delete;
+
+    EpochTally::Instance borrow(const Graph::Node count);
+
+    /**
+     * The number of tables waiting to be borrowed.
+     */
+    size_t getIdleCount() const;
+
+    static TablePool& local();
+
+    static constexpr const size_t DEFAULT_LIMIT = 64;
+
+private:
+    std::shared_ptr<EpochTally::Shelf> shelf;
+};
+
+struct EpochTally::Shelf {
+
+    std::mutex mutex;
+    std::vector<EpochTally*> idle;
+    size_t limit;
+
+    ~Shelf();
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_TABLEPOOL_H
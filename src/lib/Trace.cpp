@@ -0,0 +1,219 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <unistd.h> // getpid
+
+#include <algorithm> // min
+#include <chrono>
+#include <memory> // shared_ptr
+#include <mutex>
+#include <vector>
+
+#include "Trace.h"
+
+namespace granky {
+
+namespace {
+
+struct Event {
+
+    const char* name;
+    char type;
+    uint64_t start;
+    uint64_t duration;
+    const char* label;
+    int64_t value;
+    const char* otherLabel;
+    int64_t otherValue;
+};
+
+struct Buffer {
+
+    std::vector<Event> ring;
+    size_t next = 0;
+    size_t count = 0;
+    int thread = 0;
+};
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<Buffer>> registry;
+std::atomic<size_t> capacity(Trace::DEFAULT_CAPACITY);
+const auto epoch = std::chrono::steady_clock::now();
+
+/**
+ * The calling thread's buffer, registered on first use so that write can find it.
+ */
+Buffer& local() {
+
+    thread_local std::shared_ptr<Buffer> ret;
+
+    if(!ret) {
+
+        ret = std::make_shared<Buffer>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        ret->thread = static_cast<int>(registry.size()) + 1;
+        registry.push_back(ret);
+    }
+
+    return *ret;
+}
+
+void writeName(std::ostream& out, const char* name) {
+
+    out << '"';
+
+    for(const char* it = name; *it; ++it) {
+
+        if(*it == '"' || *it == '\\') {
+
+            out << '\\';
+        }
+
+        out << *it;
+    }
+
+    out << '"';
+}
+
+} // namespace
+
+std::atomic<bool> Trace::enabled(false);
+
+Trace::Span::Span(const char* n) : name(n), start(isEnabled() ? now() : 0) {}
+
+Trace::Span::~Span() {
+
+    if(start && isEnabled()) {
+
+        const auto stop = now();
+        record(name, 'X', start, stop - start, nullptr, 0, nullptr, 0);
+    }
+}
+
+void Trace::enable(const size_t c) {
+
+    capacity.store(c > 0 ? c : 1);
+    enabled.store(true);
+}
+
+void Trace::disable() {
+
+    enabled.store(false);
+}
+
+void Trace::instant(const char* name, const char* label, const int64_t value, const char* otherLabel, const int64_t otherValue) {
+
+    if(isEnabled()) {
+
+        record(name, 'i', now(), 0, label, value, otherLabel, otherValue);
+    }
+}
+
+void Trace::write(std::ostream& out) {
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const auto pid = getpid();
+    bool first = true;
+
+    out << "{\"traceEvents\": [";
+
+    for(const auto& buffer : registry) {
+
+        const auto size = buffer->ring.size();
+
+        // the oldest event sits at next once the ring has wrapped
+        for(size_t i = 0; i < buffer->count; ++i) {
+
+            const auto& event = buffer->ring[(buffer->next + size - buffer->count + i) % size];
+
+            out << (first ? "\n" : ",\n") << "  {\"name\": ";
+            writeName(out, event.name);
+            out << ", \"ph\": \"" << event.type << "\", \"pid\": " << pid << ", \"tid\": " << buffer->thread
+                << ", \"ts\": " << event.start / 1000.0;
+
+            if(event.type == 'X') {
+
+                out << ", \"dur\": " << event.duration / 1000.0;
+            }
+            else {
+
+                out << ", \"s\": \"t\"";
+            }
+
+            if(event.label) {
+
+                out << ", \"args\": {";
+                writeName(out, event.label);
+                out << ": " << event.value;
+
+                if(event.otherLabel) {
+
+                    out << ", ";
+                    writeName(out, event.otherLabel);
+                    out << ": " << event.otherValue;
+                }
+
+                out << "}";
+            }
+
+            out << "}";
+            first = false;
+        }
+    }
+
+    out << "\n], \"displayTimeUnit\": \"ns\"}" << std::endl;
+}
+
+void Trace::clear() {
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    for(const auto& buffer : registry) {
+
+        buffer->next = 0;
+        buffer->count = 0;
+    }
+}
+
+uint64_t Trace::now() {
+
+    // offset by one so that a recorded start is never zero
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count() + 1;
+}
+
+void Trace::record(const char* name, const char type, const uint64_t start, const uint64_t duration,
+        const char* label, const int64_t value, const char* otherLabel, const int64_t otherValue) {
+
+    auto& buffer = local();
+
+    if(buffer.ring.size() != capacity.load(std::memory_order_relaxed)) {
+
+        buffer.ring.assign(capacity.load(std::memory_order_relaxed), {});
+        buffer.next = 0;
+        buffer.count = 0;
+    }
+
+    buffer.ring[buffer.next] = {name, type, start, duration, label, value, otherLabel, otherValue};
+    buffer.next = (buffer.next + 1) % buffer.ring.size();
+    buffer.count = std::min(buffer.count + 1, buffer.ring.size());
+}
+
+} // namespace granky
@@ -0,0 +1,100 @@
+/**
+Granky is a toy graphing library created for practice, based on
+William Fiset's graphing algorithm tutorial.
+(https://youtu.be/7fujbpJ0LB4)
+
+Copyright (C) 2021 George Cesana ne Guy
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRANKY_LIB_TRACE_H
+#define GRANKY_LIB_TRACE_H
+
+#include <atomic>
+#include <cstdint> // int64_t, uint64_t
+#include <ostream>
+
+/**
+ * GRANKY_TRACE records a span named by a string literal, lasting until the
+ * end of the enclosing scope. Defining GRANKY_NO_TRACE compiles spans out.
+ */
+#ifndef GRANKY_NO_TRACE
+#define GRANKY_TRACE(__nme__) const granky::Trace::Span traceSpan(__nme__)
+#else
+#define GRANKY_TRACE(__nme__) ((void) 0)
+#endif
+
+namespace granky {
+
+/**
+ * A tracer for the library's phases: parsing, storage growth, table
+ * allocation and queries.
+ *
+ * While enabled, every thread records events into a ring buffer of its own,
+ * which keeps the newest events once full. While disabled, which is the
+ * default, a span costs one relaxed atomic load. write produces Chrome
+ * trace-event JSON, which chrome://tracing and Perfetto both open.
+ *
+ * Names and labels must be string literals, or otherwise outlive the trace.
+ * write and clear must not run while other threads are recording.
+ */
+class Trace {
+
+public:
+    class Span {
+
+    public:
+        Span(const char* name);
+        ~Span();
+
+    private:
+        const char* const name;
+        const uint64_t start;
+    };
+
+    static constexpr const size_t DEFAULT_CAPACITY = 1 << 16;
+
+    /**
+     * Starts recording, with room for capacity events on each thread.
+     */
+    static void enable(const size_t capacity = DEFAULT_CAPACITY);
+    static void disable();
+
+    static inline bool isEnabled() {
+
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Records a moment, with up to two labelled values.
+     */
+    static void instant(const char* name,
+            const char* label = nullptr, const int64_t value = 0,
+            const char* otherLabel = nullptr, const int64_t otherValue = 0);
+
+    static void write(std::ostream& out);
+    static void clear();
+
+private:
+    static std::atomic<bool> enabled;
+
+    static uint64_t now();
+    static void record(const char* name, const char type, const uint64_t start, const uint64_t duration,
+            const char* label, const int64_t value, const char* otherLabel, const int64_t otherValue);
+};
+
+} // namespace granky
+
+#endif // GRANKY_LIB_TRACE_H
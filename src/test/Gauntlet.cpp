@@ -1,12 +1,41 @@
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdlib> // mkdtemp
+#include <cstring>
+#include <filesystem>
 #include <functional>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
+#include "../lib/BatchQuery.h"
+#include "../lib/BitGraph.h"
+#include "../lib/Cluster.h"
+#include "../lib/ComponentTracker.h"
+#include "../lib/CompressedGraph.h"
+#include "../lib/ContractionHierarchy.h"
+#include "../lib/DynamicShortestPaths.h"
+#include "../lib/EdgeStream.h"
+#include "../lib/Executor.h"
+#include "../lib/Generator.h"
 #include "../lib/Graph.h"
 #include "../lib/HashGraph.h"
 #include "../lib/MatrixGraph.h"
+#include "../lib/Partition.h"
+#include "../lib/PathQuery.h"
+#include "../lib/Permutation.h"
 #include "../lib/Query.h"
+#include "../lib/QueryCache.h"
+#include "../lib/ReachabilityIndex.h"
+#include "../lib/Service.h"
+#include "../lib/ShardedGraph.h"
+#include "../lib/SnapshotGraph.h"
+#include "../lib/TablePool.h"
+#include "../lib/Trace.h"
 
 #define TEST2(__cnd__, __lft__, __rgt__) \
     {if(!(__cnd__)) {\
@@ -190,6 +219,1445 @@ int main(int argc, const char** argv) {
         TEST1(dfs.yieldWeight() == 1.0, *graph);
     }
 
+    {
+        const granky::Graph::Node side = 8;
+        auto graph = granky::Graph::create<granky::MatrixGraph>();
+
+        for(granky::Graph::Node r = 0; r < side; ++r) {
+
+            for(granky::Graph::Node c = 0; c < side; ++c) {
+
+                if(c + 1 < side) graph->addDoubleEdge(r * side + c, r * side + c + 1, 1.0);
+                if(r + 1 < side) graph->addDoubleEdge(r * side + c, (r + 1) * side + c, 1.0);
+            }
+        }
+
+        const auto manhattan = [side](granky::Graph::Node node, granky::Graph::Node sink) {
+
+            return static_cast<granky::Graph::Weight>(
+                    abs(node / side - sink / side) + abs(node % side - sink % side));
+        };
+
+        granky::AStar<granky::ZeroHeuristic> dijkstra;
+        granky::AStar astar(manhattan);
+        dijkstra.init(graph.get());
+        astar.init(graph.get());
+
+        for(int i = 0; i < 2; ++i) {
+
+            dijkstra.setSource(0);
+            dijkstra.setSink(side * side - 1);
+            dijkstra.execute();
+            astar.setSource(0);
+            astar.setSink(side * side - 1);
+            astar.execute();
+            TEST1(dijkstra.yieldWeight() == 14.0, *graph);
+            TEST1(astar.yieldWeight() == 14.0, *graph);
+            TEST1(astar.yieldExpanded() < dijkstra.yieldExpanded(), *graph);
+            TEST1(std::distance(astar.yieldSequence().begin(), astar.yieldSequence().end()) == 14, *graph);
+            TEST1(astar.yieldSequence().front().from == 0, *graph);
+        }
+
+        astar.setSource(side);
+        astar.setSink(1);
+        astar.execute();
+        TEST1(astar.yieldWeight() == 2.0, *graph);
+
+        graph->addNode(side * side);
+        astar.setSink(side * side);
+        astar.execute();
+        TEST1(!granky::Graph::isWeight(astar.yieldWeight()) && astar.yieldNode() == -1, *graph);
+    }
+
+    {
+        auto graph = granky::Graph::create<granky::HashGraph>("in/Fiset3.gky");
+        const auto end = graph->getEndNode();
+
+        const auto hops = [&graph, end](granky::Graph::Node from, granky::Graph::Node to) {
+
+            std::vector<granky::Graph::Node> depth(end, -1);
+            std::vector<granky::Graph::Node> queue(1, from);
+            depth[from] = 0;
+
+            for(size_t i = 0; i < queue.size(); ++i) {
+
+                const auto at = queue[i];
+
+                const granky::Graph::ProgressCall callback = [&](granky::Graph::Node n, granky::Graph::Weight) {
+
+                    if(depth[n] < 0) {
+
+                        depth[n] = depth[at] + 1;
+                        queue.push_back(n);
+                    }
+
+                    return -1;
+                };
+
+                graph->forEachEgress(at, callback);
+            }
+
+            return depth[to];
+        };
+
+        for(const size_t rounds : {1, 30}) {
+
+            granky::MultiSourceBFS bfs;
+            std::vector<granky::Graph::Node> sources;
+            bfs.init(graph.get());
+
+            for(size_t r = 0; r < rounds; ++r) {
+
+                graph->forEachNode([&](granky::Graph::Node n) {
+
+                    bfs.addSource(n);
+                    sources.push_back(n);
+                    return -1;
+                });
+            }
+
+            bfs.execute();
+            TEST1(bfs.yieldNode() == sources.size(), *graph);
+
+            for(size_t i = 0; i < sources.size(); i += 7) {
+
+                for(granky::Graph::Node n = 0; n < end; ++n) {
+
+                    TEST1(bfs.yieldDistance(i, n) == hops(sources[i], n), *graph);
+                }
+            }
+
+            TEST1(rounds == 1 || bfs.yieldCloseness(0) == bfs.yieldCloseness(graph->getNodeCount()), *graph);
+        }
+    }
+
+    {
+        auto matrix = granky::Graph::create<granky::MatrixGraph>("in/Fiset3.gky");
+        auto hash = granky::Graph::create<granky::HashGraph>();
+        std::srand(7);
+
+        for(granky::Graph::Node i = 0; i < 200; ++i) {
+
+            hash->addEdge(std::rand() % 60, std::rand() % 60, 1 + std::rand() % 9);
+        }
+
+        for(auto graph : {matrix.get(), hash.get()}) {
+
+            granky::AStar<granky::ZeroHeuristic> dijkstra;
+            granky::BidirectionalDijkstra bidirectional;
+            dijkstra.init(graph);
+            bidirectional.init(graph);
+
+            for(granky::Graph::Node s = 0; s < graph->getEndNode(); ++s) {
+
+                for(granky::Graph::Node t = 0; t < graph->getEndNode(); ++t) {
+
+                    if(!graph->haveNode(s) || !graph->haveNode(t)) {
+
+                        continue;
+                    }
+
+                    dijkstra.setSource(s);
+                    dijkstra.setSink(t);
+                    dijkstra.execute();
+                    bidirectional.setSource(s);
+                    bidirectional.setSink(t);
+                    bidirectional.execute();
+
+                    const auto expected = dijkstra.yieldWeight();
+                    const auto got = bidirectional.yieldWeight();
+                    TEST1(expected == got || (!granky::Graph::isWeight(expected) && !granky::Graph::isWeight(got)), *graph);
+                    TEST1(bidirectional.yieldNode() == dijkstra.yieldNode(), *graph);
+
+                    granky::Graph::Weight sum = 0.0;
+                    granky::Graph::Node at = s;
+
+                    for(const auto& edge : bidirectional.yieldSequence()) {
+
+                        TEST1(edge.from == at && graph->haveEdge(edge.from, edge.to, edge.weight), *graph);
+                        sum += edge.weight;
+                        at = edge.to;
+                    }
+
+                    TEST1(!granky::Graph::isWeight(got) || (sum == got && at == t), *graph);
+                }
+            }
+        }
+    }
+
+    {
+        auto graph = granky::Graph::create<granky::HashGraph>();
+        std::srand(11);
+
+        for(granky::Graph::Node i = 0; i < 400; ++i) {
+
+            const granky::Graph::Node from = std::rand() % 100;
+            graph->addDoubleEdge(from, (from + 1 + std::rand() % 5) % 100, 1 + std::rand() % 20);
+        }
+
+        for(granky::Graph::Node i = 0; i < 40; ++i) {
+
+            graph->addEdge(std::rand() % 100, std::rand() % 100, 1 + std::rand() % 50);
+        }
+
+        graph->addNode(100);
+
+        granky::ContractionHierarchy built;
+        built.build(*graph);
+        TEST1(built.getShortcutCount() > 0, *graph);
+
+        std::stringstream stream;
+        built.save(stream);
+        granky::ContractionHierarchy hierarchy;
+        TEST1(hierarchy.load(stream) && hierarchy.getArcCount() == built.getArcCount(), *graph);
+
+        std::stringstream garbage("not a hierarchy");
+        granky::ContractionHierarchy broken;
+        TEST1(!broken.load(garbage) && broken.getEndNode() == 0, *graph);
+
+        // an arc pointing past the last node, or a node size from another build, is refused
+        const auto image = stream.str();
+        auto stray = image;
+        const auto arcs = 8 + 2 * sizeof(uint32_t) + sizeof(uint64_t) + 101 * sizeof(granky::Graph::Node) + sizeof(uint64_t) * (1 + 102) + sizeof(uint64_t);
+        const granky::Graph::Node far = 1000;
+        memcpy(&stray[arcs], &far, sizeof(far));
+        std::stringstream strayStream(stray);
+        TEST1(!broken.load(strayStream) && broken.getEndNode() == 0, *graph);
+
+        auto resized = image;
+        resized[8] ^= 0x0c;
+        std::stringstream resizedStream(resized);
+        TEST1(!broken.load(resizedStream) && broken.getEndNode() == 0, *graph);
+
+        // so is an arc leading down in rank, or a shortcut through a node above its ends
+        const auto arcSize = 2 * sizeof(granky::Graph::Node) + sizeof(granky::Graph::Weight);
+        const auto first = hierarchy.beginUp(0, true);
+        granky::Graph::Node owner = 0;
+
+        while(hierarchy.beginUp(owner, true) == hierarchy.endUp(owner, true)) {
+
+            ++owner;
+        }
+
+        size_t raisedCount = 0;
+        auto downward = image;
+        memcpy(&downward[arcs], &owner, sizeof(owner));
+        std::stringstream downwardStream(downward);
+        TEST1(!broken.load(downwardStream) && broken.getEndNode() == 0, owner);
+
+        for(granky::Graph::Node n = 0; n <= 100; ++n) {
+
+            for(auto it = hierarchy.beginUp(n, true); it != hierarchy.endUp(n, true); ++it) {
+
+                if(granky::Graph::isNode(it->middle)) {
+
+                    auto raised = image;
+                    memcpy(&raised[arcs + (it - first) * arcSize + sizeof(granky::Graph::Node) + sizeof(granky::Graph::Weight)], &it->to, sizeof(it->to));
+                    std::stringstream raisedStream(raised);
+                    TEST1(!broken.load(raisedStream) && broken.getEndNode() == 0, n);
+                    ++raisedCount;
+                }
+            }
+        }
+
+        TEST1(raisedCount > 0, raisedCount);
+
+        granky::AStar<granky::ZeroHeuristic> dijkstra;
+        granky::HierarchyQuery query(hierarchy);
+        dijkstra.init(graph.get());
+        query.init(nullptr);
+
+        for(granky::Graph::Node s = 0; s <= 100; ++s) {
+
+            for(granky::Graph::Node t = 0; t <= 100; t += 3) {
+
+                dijkstra.setSource(s);
+                dijkstra.setSink(t);
+                dijkstra.execute();
+                query.setSource(s);
+                query.setSink(t);
+                query.execute();
+
+                const auto expected = dijkstra.yieldWeight();
+                const auto got = query.yieldWeight();
+                TEST1(expected == got || (!granky::Graph::isWeight(expected) && !granky::Graph::isWeight(got)), *graph);
+
+                granky::Graph::Weight sum = 0.0;
+                granky::Graph::Node at = s;
+
+                for(const auto& edge : query.yieldSequence()) {
+
+                    TEST1(edge.from == at && graph->haveEdge(edge.from, edge.to, edge.weight), *graph);
+                    sum += edge.weight;
+                    at = edge.to;
+                }
+
+                TEST1(!granky::Graph::isWeight(got) || (sum == got && at == t), *graph);
+            }
+        }
+
+        // a hierarchy query has no graph to key a cache on, and is always executed
+        granky::QueryCache cache;
+        query.setSource(0);
+        query.setSink(99);
+        dijkstra.setSource(0);
+        dijkstra.setSink(99);
+        dijkstra.execute();
+        TEST1(!cache.execute(query) && !cache.execute(query) && cache.getStats().size == 0, cache.getStats().hits);
+        TEST1(query.yieldWeight() == dijkstra.yieldWeight() || !granky::Graph::isWeight(dijkstra.yieldWeight()), *graph);
+    }
+
+    {
+        auto graph = granky::Graph::create<granky::HashGraph>("in/Fiset3.gky");
+        std::srand(13);
+
+        for(granky::Graph::Node i = 0; i < 120; ++i) {
+
+            graph->addEdge(20 + std::rand() % 80, 20 + std::rand() % 80, 1.0);
+        }
+
+        granky::ReachabilityIndex index;
+        index.build(*graph);
+        TEST1(index.getFootprint() > 0 && index.getComponentCount() < graph->getNodeCount(), *graph);
+
+        for(granky::Graph::Node from = 0; from <= graph->getEndNode(); ++from) {
+
+            granky::RecursiveDFS dfs;
+            dfs.init(graph.get());
+
+            if(graph->haveNode(from)) {
+
+                dfs.setSource(from);
+                dfs.execute();
+            }
+
+            for(granky::Graph::Node to = 0; to <= graph->getEndNode(); ++to) {
+
+                const bool expected = graph->haveNode(from) && graph->haveNode(to)
+                    && granky::Graph::isNode(dfs.yieldTable()->get(to));
+                TEST1(index.canReach(from, to) == expected, *graph);
+            }
+        }
+    }
+
+    {
+        auto graph = granky::Graph::create<granky::HashGraph>("in/Fiset4.gky");
+        auto other = granky::Graph::create<granky::MatrixGraph>("in/Fiset4.gky");
+        const auto version = graph->getVersion();
+        TEST2(version != other->getVersion(), *graph, *other);
+
+        graph->addNode(0);
+        TEST1(graph->getVersion() == version, *graph);
+
+        granky::QueryCache cache(2);
+        granky::BidirectionalDijkstra query;
+        query.init(graph.get());
+        query.setSource(1);
+        query.setSink(16);
+
+        TEST1(!cache.execute(query) && query.yieldWeight() == 2.0, *graph);
+        TEST1(cache.execute(query) && query.yieldWeight() == 2.0, *graph);
+        TEST1(query.yieldTable()->get(5) == 1 && query.yieldSequence().front().to == 5, *graph);
+
+        // hits share the cached table rather than copying it
+        granky::BidirectionalDijkstra again;
+        again.init(graph.get());
+        again.setSource(1);
+        again.setSink(16);
+        TEST1(cache.execute(again) && again.yieldTable() == query.yieldTable(), *graph);
+
+        query.setSink(4);
+        TEST1(!cache.execute(query) && !granky::Graph::isWeight(query.yieldWeight()), *graph);
+
+        graph->addEdge(16, 4, 1.0);
+        TEST1(graph->getVersion() > version, *graph);
+        TEST1(!cache.execute(query) && query.yieldWeight() == 3.0, *graph);
+
+        query.setSink(16);
+        TEST1(!cache.execute(query) && query.yieldWeight() == 2.0, *graph);
+        query.execute();
+        TEST1(query.yieldWeight() == 2.0 && query.yieldTable()->get(5) == 1, *graph);
+
+        const auto stats = cache.getStats();
+        TEST1(stats.hits == 2 && stats.misses == 4 && stats.evictions == 2 && stats.size == 2, *graph);
+    }
+
+    {
+        // a hit on a fresh query restores what its subclass yields too
+        auto graph = granky::Graph::create<granky::HashGraph>("in/Fiset4.gky");
+        granky::QueryCache cache;
+        granky::AStar<granky::ZeroHeuristic> first;
+        granky::AStar<granky::ZeroHeuristic> second;
+
+        for(auto each : {&first, &second}) {
+
+            each->init(graph.get());
+            each->setSource(1);
+            each->setSink(16);
+        }
+
+        TEST1(!cache.execute(first) && cache.execute(second), *graph);
+        TEST1(second.yieldExpanded() == first.yieldExpanded() && second.yieldExpanded() > 0, second.yieldExpanded());
+
+        granky::MultiSourceBFS batch;
+        granky::MultiSourceBFS cached;
+
+        for(auto each : {&batch, &cached}) {
+
+            each->init(graph.get());
+            each->addSource(0);
+            each->addSource(5);
+        }
+
+        TEST1(!cache.execute(batch, 5) && cache.execute(cached, 5), *graph);
+
+        for(granky::Graph::Node n = 0; n < graph->getEndNode(); ++n) {
+
+            TEST1(cached.yieldDistance(1, n) == batch.yieldDistance(1, n), n);
+        }
+
+        TEST1(cached.yieldCloseness(0) == batch.yieldCloseness(0) && cached.yieldCloseness(1) == batch.yieldCloseness(1), cached.yieldCloseness(1));
+
+        // incremental queries are never served from the cache
+        granky::DynamicShortestPaths dynamic;
+        dynamic.init(graph.get());
+        dynamic.setSource(1);
+        dynamic.setSink(16);
+        TEST1(!cache.execute(dynamic) && !cache.execute(dynamic) && dynamic.yieldWeight() == 2.0, dynamic.yieldWeight());
+        TEST1(cache.getStats().hits == 2 && cache.getStats().size == 2, cache.getStats().size);
+    }
+
+    {
+        auto matrix = granky::Graph::create<granky::MatrixGraph>();
+        auto hash = granky::Graph::create<granky::HashGraph>();
+        auto source = granky::Graph::create<granky::HashGraph>("in/Fiset4.gky");
+        matrix->addEdge(3, 9, 1.0);
+        hash->addEdge(3, 9, 1.0);
+
+        granky::ComponentTracker matrixTracker;
+        granky::ComponentTracker hashTracker;
+        matrixTracker.init(matrix.get());
+        hashTracker.init(hash.get());
+
+        const auto check = [](granky::Graph& graph, granky::ComponentTracker& tracker) {
+
+            granky::ColorComponents colors;
+            colors.init(&graph);
+            colors.execute();
+            tracker.execute();
+
+            for(granky::Graph::Node n = 0; n < graph.getEndNode(); ++n) {
+
+                TEST1(tracker.yieldTable()->get(n) == colors.yieldTable()->get(n), graph);
+            }
+
+            return tracker.yieldNode();
+        };
+
+        const granky::Graph::EdgeCall edgeCall = [&](granky::Graph::Node from, granky::Graph::Node to, granky::Graph::Weight weight) {
+
+            matrix->addEdge(from, to, weight);
+            hash->addEdge(from, to, weight);
+            check(*matrix, matrixTracker);
+            check(*hash, hashTracker);
+            return -1;
+        };
+
+        source->forEachEdge(edgeCall);
+        matrix->addNode(12);
+        hash->addNode(12);
+
+        TEST1(check(*matrix, matrixTracker) == 5 && matrixTracker.getComponentCount() == 5, *matrix);
+        TEST1(check(*hash, hashTracker) == 5, *hash);
+        TEST1(hashTracker.isConnected(0, 13) && !hashTracker.isConnected(0, 6), *hash);
+        TEST1(matrixTracker.isConnected(10, 3) && !matrixTracker.isConnected(12, 1), *matrix);
+
+        hash->addEdge(12, 6, 1.0);
+        TEST1(hashTracker.getComponentCount() == 4 && hashTracker.isConnected(12, 11), *hash);
+    }
+
+    {
+        auto graph = granky::Graph::create<granky::HashGraph>();
+        std::srand(17);
+
+        for(granky::Graph::Node i = 0; i < 150; ++i) {
+
+            graph->addEdge(std::rand() % 60, std::rand() % 60, 10 + std::rand() % 90);
+        }
+
+        granky::DynamicShortestPaths dynamic;
+        granky::AStar<granky::ZeroHeuristic> dijkstra;
+        dynamic.init(graph.get());
+        dynamic.setSource(0);
+        dynamic.setSink(59);
+        dynamic.execute();
+        const auto full = dynamic.yieldSettled();
+
+        for(granky::Graph::Node round = 0; round < 60; ++round) {
+
+            const granky::Graph::Node from = std::rand() % 70;
+            const granky::Graph::Node to = std::rand() % 70;
+            const auto known = graph->getWeight(from, to);
+            const granky::Graph::Weight w = granky::Graph::isWeight(known) && round % 3 ? known / 2 : 1 + std::rand() % 100;
+            graph->addEdge(from, to, w);
+            dynamic.execute();
+            TEST1(round % 3 != 1 || dynamic.yieldSettled() <= full, *graph);
+
+            dijkstra.init(graph.get());
+            dijkstra.setSource(0);
+
+            for(granky::Graph::Node n = 0; n < graph->getEndNode(); ++n) {
+
+                if(!graph->haveNode(n)) {
+
+                    continue;
+                }
+
+                dijkstra.setSink(n);
+                dijkstra.execute();
+                const auto expected = dijkstra.yieldWeight();
+                const auto got = dynamic.yieldDistance(n);
+                TEST1(expected == got || (!granky::Graph::isWeight(expected) && !granky::Graph::isWeight(got)), *graph);
+            }
+
+            dijkstra.setSink(59);
+            dijkstra.execute();
+            TEST1(dynamic.yieldWeight() == dijkstra.yieldWeight() || isnan(dijkstra.yieldWeight()), *graph);
+        }
+    }
+
+    {
+        auto before = granky::Graph::create<granky::HashGraph>("in/Fiset3.gky");
+        auto after = granky::Graph::create<granky::MatrixGraph>("in/Fiset3.gky");
+        TEST2(before->getFingerprint() == after->getFingerprint(), *before, *after);
+        TEST2(before->getEdgeCount() == 14 && after->getEdgeCount() == 14, *before, *after);
+
+        after->addEdge(0, 9, 2.0);
+        TEST2(*before != *after && before->getFingerprint() != after->getFingerprint(), *before, *after);
+        after->addEdge(0, 9, 1.0);
+        TEST2(*before == *after && before->getFingerprint() == after->getFingerprint(), *before, *after);
+
+        after->addEdge(7, 10, 5.0);
+        after->addEdge(12, 4, 1.0);
+        after->addEdge(13, 12, 1.0);
+        before->addEdge(2, 6, 1.0);
+
+        for(const unsigned threads : {1u, 3u, 0u}) {
+
+            const auto diff = granky::Graph::diff(*before, *after, threads);
+            TEST2(std::distance(diff.added.begin(), diff.added.end()) == 2, *before, *after);
+            TEST2(std::distance(diff.removed.begin(), diff.removed.end()) == 1, *before, *after);
+            TEST2(diff.removed.front().from == 2 && diff.removed.front().to == 6, *before, *after);
+            TEST2(diff.reweighted.front().weight == 5.0 && std::next(diff.reweighted.begin()) == diff.reweighted.end(), *before, *after);
+        }
+    }
+
+    {
+        auto grid = granky::Graph::create<granky::HashGraph>();
+        granky::GridGenerator(3, 4).generate(*grid);
+        TEST1(grid->getEdgeCount() == 34 && grid->getEndNode() == 12, *grid);
+        TEST1(grid->getWeight(5, 9) == 1.0 && grid->getWeight(9, 5) == 1.0 && !grid->haveEdge(3, 4), *grid);
+
+        granky::ErdosRenyiGenerator gnp(50, 0.1, 7);
+        gnp.setMaxWeight(9);
+        std::stringstream text;
+        gnp.write(text, 2);
+        auto parsed = granky::Graph::create<granky::HashGraph>();
+        parsed->parseString(text.str());
+        auto direct = granky::Graph::create<granky::MatrixGraph>();
+        gnp.generate(*direct);
+        TEST2(*parsed == *direct, *parsed, *direct);
+
+        // spans several chunks, so that threads share the work
+        granky::ChungLuGenerator chungLu(1 << 19, 3.0, 2.5, 11);
+        TEST1(chungLu.getChunkCount() == 2, chungLu.getChunkCount());
+
+        const auto digest = [&chungLu](const unsigned threads) {
+
+            uint64_t ret = 0;
+
+            const granky::Graph::EdgeCall edgeCall = [&ret](granky::Graph::Node from, granky::Graph::Node to, granky::Graph::Weight) {
+
+                ret = ret * 31 + uint64_t(from) * 1000003 + to;
+                return -1;
+            };
+
+            chungLu.generate(edgeCall, threads);
+            return ret;
+        };
+
+        TEST2(digest(1) == digest(4), digest(1), digest(4));
+
+        granky::RMatGenerator first(10, 8, 3);
+        granky::RMatGenerator second(10, 8, 3);
+        granky::RMatGenerator other(10, 8, 4);
+        std::stringstream a, b, c;
+        first.write(a, 1);
+        second.write(b, 3);
+        other.write(c);
+        TEST1(a.str() == b.str() && a.str() != c.str(), "R-MAT is not deterministic");
+    }
+
+    {
+        auto graph = granky::Graph::create<granky::HashGraph>();
+        graph->parseString("0 1 1\n1 2 1\n2 3 1\n");
+
+        granky::RecursiveDFS dfs;
+        dfs.init(graph.get());
+        dfs.setSource(0);
+        dfs.execute();
+        const auto& stats = dfs.yieldStats();
+
+        granky::AStar<granky::ZeroHeuristic> astar;
+        astar.init(graph.get());
+        astar.setSource(0);
+        astar.setSink(3);
+        astar.execute();
+        astar.execute();
+
+#ifdef GRANKY_STATS
+        TEST1(stats.visited == 4 && stats.examined == 3 && stats.callbacks == 3 && stats.allocations == 1, stats.visited);
+        TEST1(stats.getSeconds("init") > 0.0 && stats.getSeconds("execute") > 0.0 && stats.getTeps() > 0.0, stats.getTeps());
+        TEST1(astar.yieldStats().visited == 8 && astar.yieldStats().examined == 6, astar.yieldStats().visited);
+        astar.resetStats();
+        TEST1(astar.yieldStats().examined == 0 && astar.yieldStats().phases.empty(), astar.yieldStats().examined);
+#else
+        TEST1(stats.visited == 0 && stats.examined == 0 && stats.phases.empty() && stats.getTeps() == 0.0, stats.visited);
+        TEST1(astar.yieldStats().examined == 0, astar.yieldStats().examined);
+#endif
+    }
+
+    {
+        granky::Trace::enable();
+        auto graph = granky::Graph::create<granky::MatrixGraph>();
+        graph->parseString("0 1 1\n1 2 1\n");
+
+        granky::RecursiveDFS dfs;
+        dfs.init(graph.get());
+        dfs.setSource(0);
+        dfs.execute();
+
+        std::thread([]() { granky::Trace::instant("worker", "value", 7); }).join();
+
+        std::stringstream trace;
+        granky::Trace::write(trace);
+        const auto text = trace.str();
+#ifndef GRANKY_NO_TRACE
+        TEST1(text.find("\"name\": \"Graph::parse\", \"ph\": \"X\"") != std::string::npos, text);
+        TEST1(text.find("MatrixGraph::grow") != std::string::npos && text.find("RecursiveDFS::execute") != std::string::npos, text);
+#else
+        TEST1(text.find("\"ph\": \"X\"") == std::string::npos, text);
+#endif
+        TEST1(text.find("\"worker\", \"ph\": \"i\"") != std::string::npos && text.find("\"args\": {\"value\": 7}") != std::string::npos, text);
+
+        // a full ring keeps the newest events
+        granky::Trace::clear();
+        granky::Trace::enable(2);
+
+        for(int i = 0; i < 5; ++i) {
+
+            granky::Trace::instant("ring", "i", i);
+        }
+
+        granky::Trace::disable();
+        granky::Trace::instant("ignored");
+        std::stringstream ring;
+        granky::Trace::write(ring);
+        TEST1(ring.str().find("\"i\": 3") != std::string::npos && ring.str().find("\"i\": 4") != std::string::npos, ring.str());
+        TEST1(ring.str().find("\"i\": 2") == std::string::npos && ring.str().find("ignored") == std::string::npos, ring.str());
+        granky::Trace::clear();
+    }
+
+    {
+        auto graph = granky::Graph::create<granky::MatrixGraph>();
+        granky::GridGenerator(3, 3).generate(*graph);
+        const auto edges = graph->getEdges();
+        TEST1(edges.size() == 24 && edges.capacity() == 24 && edges.front().from == 0 && edges.back().from == 8, *graph);
+
+        size_t blocks = 0;
+        size_t total = 0;
+
+        const granky::Graph::BlockCall blockCall = [&blocks, &total](const granky::Graph::EdgeList& block) {
+
+            ++blocks;
+            total += block.size();
+            return -1;
+        };
+
+        graph->forEachEdgeBlock(blockCall, 5);
+        TEST2(blocks == 5 && total == 24, blocks, total);
+
+        const granky::Graph::BlockCall stopCall = [&blocks](const granky::Graph::EdgeList& block) {
+
+            ++blocks;
+            return block.back().to;
+        };
+
+        blocks = 0;
+        TEST1(graph->forEachEdgeBlock(stopCall, 5) == edges[4].to && blocks == 1, blocks);
+    }
+
+    {
+        granky::TablePool pool(2);
+        auto first = pool.borrow(4);
+        first->set(3, 7);
+        TEST1(first->get(3) == 7 && first->get(0) == -1, first->get(3));
+        const auto address = first.get();
+        const auto copy = first->clone();
+        first = nullptr;
+        TEST1(pool.getIdleCount() == 1 && copy->get(3) == 7, pool.getIdleCount());
+
+        // a returned table comes back blank, and grown if need be
+        auto second = pool.borrow(10);
+        TEST1(second.get() == address && second->get(3) == -1 && second->getSize() == 10, second->get(3));
+        second->set(9, 1);
+        std::thread([&second]() { second = nullptr; }).join();
+        TEST1(pool.getIdleCount() == 1, pool.getIdleCount());
+
+        auto a = pool.borrow(1);
+        auto b = pool.borrow(1);
+        auto c = pool.borrow(1);
+        a = nullptr;
+        b = nullptr;
+        c = nullptr;
+        TEST1(pool.getIdleCount() == 2, pool.getIdleCount());
+
+        // tables outliving their pool are deleted rather than returned
+        granky::EpochTally::Instance orphan;
+        {
+            granky::TablePool gone;
+            orphan = gone.borrow(2);
+        }
+        orphan = nullptr;
+
+        auto graph = granky::Graph::create<granky::HashGraph>();
+        graph->parseString("0 1 1\n1 2 1\n");
+        const auto idle = granky::TablePool::local().getIdleCount();
+        {
+            granky::RecursiveDFS dfs;
+            dfs.init(graph.get());
+            dfs.setSource(0);
+            dfs.execute();
+            TEST1(dfs.yieldWeight() == 2.0, dfs.yieldWeight());
+        }
+        TEST1(granky::TablePool::local().getIdleCount() == std::max<size_t>(idle, 1), granky::TablePool::local().getIdleCount());
+    }
+
+    {
+        granky::SnapshotGraph graph(16);
+        graph.parseString("0 1 2\n1 2 3\n");
+        graph.publish();
+
+        auto held = graph.read();
+        graph.addEdge(2, 3, 4);
+        graph.publish();
+        TEST1(held->getEdgeCount() == 2 && !held->haveNode(3) && graph.getEdgeCount() == 3, held->getEdgeCount());
+        TEST1(graph.read()->getWeight(2, 3) == 4.0 && graph.read()->getVersion() == graph.getVersion(), *graph.read());
+        TEST1(graph.getRetiredCount() == 1, graph.getRetiredCount());
+
+        {
+            const auto release = std::move(held);
+        }
+
+        graph.reclaim();
+        TEST1(graph.getRetiredCount() == 0, graph.getRetiredCount());
+
+        granky::AStar<granky::ZeroHeuristic> astar;
+        auto reader = graph.read();
+        astar.init(reader.get());
+        astar.setSource(0);
+        astar.setSink(3);
+        astar.execute();
+        TEST1(astar.yieldWeight() == 9.0, astar.yieldWeight());
+
+        // edges added out of order, then reweighted, are each found again
+        granky::SnapshotGraph hub;
+
+        for(granky::Graph::Node to = 99; to >= 1; to -= 2) {
+
+            hub.addEdge(0, to, to);
+            hub.addEdge(0, to - 1, 1);
+            hub.addEdge(0, to, to + 1);
+        }
+
+        hub.publish();
+        TEST1(hub.getEdgeCount() == 99 && hub.read()->getWeight(0, 51) == 52.0 && hub.read()->getWeight(0, 50) == 1.0, hub.getEdgeCount());
+        TEST1(!granky::Graph::isWeight(hub.read()->getWeight(0, 100)) && !granky::Graph::isWeight(hub.read()->getWeight(77, 0)), *hub.read());
+
+        // readers always see every ingress matching an egress, however far the writer has got
+        std::atomic<bool> done(false);
+        std::atomic<int> failures(0);
+        std::vector<std::thread> readers;
+
+        for(int i = 0; i < 3; ++i) {
+
+            readers.emplace_back([&graph, &done, &failures]() {
+
+                while(!done.load()) {
+
+                    const auto view = graph.read();
+                    size_t edges = 0;
+
+                    const granky::Graph::EdgeCall edgeCall = [&view, &edges, &failures](granky::Graph::Node from, granky::Graph::Node to, granky::Graph::Weight weight) {
+
+                        edges += from != to;
+
+                        const granky::Graph::ProgressCall ingressCall = [from, weight](granky::Graph::Node back, granky::Graph::Weight w) {
+
+                            return back == from && w == weight ? back : -1;
+                        };
+
+                        if(!granky::Graph::isNode(view->forEachIngress(to, ingressCall))) {
+
+                            ++failures;
+                        }
+
+                        return -1;
+                    };
+
+                    view->forEachEdge(edgeCall);
+                    failures += edges != view->getEdgeCount();
+                }
+            });
+        }
+
+        for(granky::Graph::Node i = 0; i < 5000; ++i) {
+
+            graph.addEdge(std::rand() % 500, std::rand() % 500, 1 + std::rand() % 9);
+        }
+
+        done.store(true);
+
+        for(auto& each : readers) {
+
+            each.join();
+        }
+
+        graph.publish();
+        TEST1(failures.load() == 0, failures.load());
+        TEST1(*graph.read() == graph, graph);
+    }
+
+    {
+        // each thread owns the tails congruent to its index, so no edge is written twice at once
+        granky::ShardedGraph graph(8);
+        auto expected = granky::Graph::create<granky::HashGraph>();
+        std::vector<std::thread> writers;
+        granky::RMatGenerator generator(10, 8, 7);
+        granky::Graph::EdgeList edges;
+        generator.setMaxWeight(9);
+
+        generator.generate([&edges](granky::Graph::Node from, granky::Graph::Node to, granky::Graph::Weight weight) {
+
+            edges.push_back({from, to, weight});
+            return -1;
+        });
+
+        for(const auto& each : edges) {
+
+            expected->addEdge(each.from, each.to, each.weight);
+        }
+
+        for(int i = 0; i < 4; ++i) {
+
+            writers.emplace_back([&graph, &edges, i]() {
+
+                for(const auto& each : edges) {
+
+                    if(each.from % 4 == i) {
+
+                        graph.addEdge(each.from, each.to, each.weight);
+                    }
+                }
+            });
+        }
+
+        for(auto& each : writers) {
+
+            each.join();
+        }
+
+        TEST1(graph == *expected, graph.getEdgeCount());
+        TEST1(graph.getNodeCount() == expected->getNodeCount() && graph.getEndNode() == expected->getEndNode(), graph.getNodeCount());
+
+        size_t ingresses = 0;
+
+        const granky::Graph::NodeCall nodeCall = [&graph, &ingresses](granky::Graph::Node to) {
+
+            graph.forEachIngress(to, [&graph, &ingresses, to](granky::Graph::Node from, granky::Graph::Weight weight) {
+
+                ingresses += graph.getWeight(from, to) == weight;
+                return -1;
+            });
+
+            return -1;
+        };
+
+        graph.forEachNode(nodeCall);
+        TEST1(ingresses == graph.getEdges().size(), ingresses);
+
+        const auto version = graph.getVersion();
+        TEST1(graph.getVersion() == version, graph.getVersion());
+        graph.addEdge(0, 1, 100);
+        TEST1(graph.getVersion() != version && graph.getWeight(0, 1) == 100.0, graph.getWeight(0, 1));
+    }
+
+    {
+        // every thread reweights the same edges, so writers of one edge race
+        granky::ShardedGraph graph(4);
+        std::vector<std::thread> writers;
+
+        for(int i = 0; i < 4; ++i) {
+
+            writers.emplace_back([&graph, i]() {
+
+                for(int round = 0; round < 200; ++round) {
+
+                    for(granky::Graph::Node from = 0; from < 16; ++from) {
+
+                        graph.addEdge(from, (from * 7 + 3) % 16, 1 + (i + round) % 9);
+                        graph.addEdge(from, from, 1 + i);
+                    }
+                }
+            });
+        }
+
+        for(auto& each : writers) {
+
+            each.join();
+        }
+
+        size_t agreeing = 0;
+
+        graph.forEachNode([&graph, &agreeing](granky::Graph::Node to) {
+
+            graph.forEachIngress(to, [&graph, &agreeing, to](granky::Graph::Node from, granky::Graph::Weight weight) {
+
+                agreeing += graph.getWeight(from, to) == weight;
+                return -1;
+            });
+
+            return -1;
+        });
+
+        auto rebuilt = granky::Graph::create<granky::HashGraph>();
+
+        for(const auto& each : graph.getEdges()) {
+
+            rebuilt->addEdge(each.from, each.to, each.weight);
+        }
+
+        TEST1(agreeing == graph.getEdges().size() && graph.getEdgeCount() == 16, agreeing);
+        TEST1(graph.getFingerprint() == rebuilt->getFingerprint(), graph.getFingerprint());
+    }
+
+    {
+        // a hub outgrows scanning its adjacency, and its edges are found through the index
+        granky::ShardedGraph graph(2);
+
+        for(int pass = 1; pass <= 2; ++pass) {
+
+            for(granky::Graph::Node to = 0; to < 100; ++to) {
+
+                graph.addEdge(0, to, pass + to);
+                graph.addEdge(to, 0, pass);
+            }
+        }
+
+        TEST1(graph.getEdgeCount() == 198 && graph.getWeight(0, 99) == 101.0 && graph.getWeight(0, 5) == 7.0, graph.getEdgeCount());
+        TEST1(graph.getWeight(42, 0) == 2.0 && !granky::Graph::isWeight(graph.getWeight(0, 100)), graph.getWeight(42, 0));
+
+        size_t digresses = 0;
+
+        graph.forEachLightDigress(0, [&digresses](granky::Graph::Node, granky::Graph::Weight) {
+
+            ++digresses;
+            return -1;
+        });
+
+        TEST1(digresses == 100, digresses);
+    }
+
+    {
+        granky::Graph::Edge edge;
+        TEST1(granky::EdgeStream::parseLine("3 4 2.5", edge) && edge.from == 3 && edge.to == 4 && edge.weight == granky::Graph::Weight(2.5), edge.weight);
+        TEST1(granky::EdgeStream::parseLine("7", edge) && edge.from == 7 && !granky::Graph::isNode(edge.to), edge.to);
+        TEST1(granky::EdgeStream::parseLine("1\t2", edge) && edge.weight == granky::Graph::DEFAULT_DEFAULT_WEIGHT, edge.weight);
+        TEST1(!granky::EdgeStream::parseLine("", edge) && !granky::EdgeStream::parseLine("-1 2", edge), edge.from);
+
+        const std::string source = "0 1 2\n1 2 3\n\n9\n2 3 1\n3 0 4\n4 5 1\n5 6 1\n";
+        auto expected = granky::Graph::create<granky::HashGraph>();
+        expected->parseString(source);
+
+        auto graph = granky::Graph::create<granky::HashGraph>();
+        granky::EdgeStream stream(*graph, 2, 1);
+        granky::AStar<granky::ZeroHeuristic> astar;
+        std::vector<granky::Graph::Weight> distances;
+
+        astar.setSource(0);
+        astar.setSink(3);
+        stream.addQuery(&astar);
+        stream.setInterval(3, std::chrono::milliseconds(0));
+
+        stream.setReport([&astar, &distances](const granky::EdgeStream::Stats&) {
+
+            distances.push_back(astar.yieldWeight());
+        });
+
+        std::stringstream in(source);
+        const auto stats = stream.run(in);
+        TEST1(*graph == *expected && graph->haveNode(9), *graph);
+        TEST1(stats.lines == 8 && stats.edges == 6 && stats.batches >= 4, stats.batches);
+        TEST1(stats.rounds == distances.size() && distances.size() >= 2 && distances.back() == 6.0, distances.size());
+    }
+
+    {
+        // holds for every node and weight type the library may be compiled with
+        TEST1(!granky::Graph::isWeight(granky::Graph::NO_WEIGHT), granky::Graph::NO_WEIGHT);
+        TEST1(granky::Graph::isWeight(granky::Graph::MAX_WEIGHT) && granky::Graph::MAX_WEIGHT > granky::Graph::DEFAULT_DEFAULT_WEIGHT, granky::Graph::MAX_WEIGHT);
+
+        auto graph = granky::Graph::create<granky::MatrixGraph>();
+        graph->parseString("0 1 3\n1 2 4\n3\n");
+        TEST1(!granky::Graph::isWeight(graph->getWeight(0, 2)) && !granky::Graph::isWeight(graph->getLightDigress(0, 3)), *graph);
+
+        granky::BidirectionalDijkstra bidirectional;
+        bidirectional.init(graph.get());
+        bidirectional.setSource(0);
+        bidirectional.setSink(3);
+        bidirectional.execute();
+        TEST1(!granky::Graph::isWeight(bidirectional.yieldWeight()), bidirectional.yieldWeight());
+        bidirectional.setSink(2);
+        bidirectional.execute();
+        TEST1(bidirectional.yieldWeight() == 7, bidirectional.yieldWeight());
+    }
+
+    {
+        granky::BitGraph graph;
+        auto expected = granky::Graph::create<granky::HashGraph>();
+
+        // enough nodes to grow past several padded rows, and no self loops, which HashGraph would keep
+        for(int i = 0; i < 3000; ++i) {
+
+            const granky::Graph::Node from = std::rand() % 700;
+            const granky::Graph::Node to = (from + 1 + std::rand() % 699) % 700;
+            graph.addEdge(from, to, 1 + std::rand() % 5);
+            expected->addEdge(from, to, 1.0);
+        }
+
+        graph.addNode(900);
+        expected->addNode(900);
+        TEST1(graph == *expected && graph.getNodeCount() == expected->getNodeCount(), graph.getEdgeCount());
+        TEST1(graph.getEndNode() == 901 && graph.haveNode(900) && !graph.haveNode(899), graph.getEndNode());
+
+        const auto count = [&expected](granky::Graph::Node a, granky::Graph::Node b, bool egress, bool ingress) {
+
+            granky::Graph::Node ret = 0;
+
+            for(granky::Graph::Node each = 0; each < expected->getEndNode(); ++each) {
+
+                const bool nearA = each != a && ((egress && expected->haveEdge(a, each)) || (ingress && expected->haveEdge(each, a)));
+                const bool nearB = each != b && ((egress && expected->haveEdge(b, each)) || (ingress && expected->haveEdge(each, b)));
+                ret += nearA && nearB;
+            }
+
+            return ret;
+        };
+
+        for(granky::Graph::Node a = 0; a < 40; ++a) {
+
+            const granky::Graph::Node b = std::rand() % 700;
+            TEST1(graph.countCommonEgresses(a, b) == count(a, b, true, false), a);
+            TEST1(graph.countCommonIngresses(a, b) == count(a, b, false, true), a);
+            TEST1(graph.countCommonDigresses(a, b) == count(a, b, true, true), a);
+
+            granky::Graph::Node ingresses = 0;
+            graph.forEachIngress(a, [&](granky::Graph::Node from, granky::Graph::Weight) { ingresses += expected->haveEdge(from, a); return -1; });
+            TEST1(ingresses == count(a, a, false, true), ingresses);
+        }
+
+        granky::BitGraph small;
+        small.parseString("0 1\n1 2\n2 0\n2 3\n3 1\n0 3\n3 0\n4 5\n");
+        TEST1(small.countTriangles() == 4, small.countTriangles());
+        TEST1(!small.haveEdge(0, 0) && small.getWeight(0, 1) == granky::Graph::DEFAULT_DEFAULT_WEIGHT, small);
+    }
+
+    {
+        // gaps of every encoded length, lists of every length modulo four, and a few hubs
+        auto source = granky::Graph::create<granky::HashGraph>();
+
+        for(int i = 0; i < 4000; ++i) {
+
+            const granky::Graph::Node from = i % 7 ? std::rand() % 300 : std::rand() % 3;
+            const granky::Graph::Node to = i % 5 ? std::rand() % 300 : std::rand() % 200000;
+            source->addEdge(from, to, 1 + std::rand() % 50);
+        }
+
+        source->addNode(200001);
+        granky::CompressedGraph graph(*source);
+        TEST1(graph == *source && graph.getNodeCount() == source->getNodeCount(), graph.getEdgeCount());
+        TEST1(graph.getVersion() == source->getVersion() && graph.haveNode(200001) && !graph.haveNode(200000), graph.getEndNode());
+
+        for(granky::Graph::Node node = 0; node < 300; ++node) {
+
+            size_t ingresses = 0;
+            size_t digresses = 0;
+
+            graph.forEachIngress(node, [&](granky::Graph::Node from, granky::Graph::Weight weight) {
+
+                ingresses += source->getWeight(from, node) == weight;
+                return -1;
+            });
+
+            graph.forEachLightDigress(node, [&](granky::Graph::Node other, granky::Graph::Weight weight) {
+
+                digresses += source->getLightDigress(node, other) == weight;
+                return -1;
+            });
+
+            size_t expected = 0;
+            size_t expectedDigresses = 0;
+            source->forEachIngress(node, [&expected](granky::Graph::Node, granky::Graph::Weight) { ++expected; return -1; });
+            source->forEachLightDigress(node, [&expectedDigresses](granky::Graph::Node, granky::Graph::Weight) { ++expectedDigresses; return -1; });
+            TEST1(ingresses == expected && digresses == expectedDigresses, node);
+        }
+
+        granky::AStar<granky::ZeroHeuristic> onSource;
+        granky::AStar<granky::ZeroHeuristic> onCompressed;
+        onSource.init(source.get());
+        onCompressed.init(&graph);
+        onSource.setSource(0);
+        onCompressed.setSource(0);
+        onSource.setSink(299);
+        onCompressed.setSink(299);
+        onSource.execute();
+        onCompressed.execute();
+        TEST1(onSource.yieldWeight() == onCompressed.yieldWeight(), onCompressed.yieldWeight());
+
+        std::stringstream image;
+        graph.save(image);
+        granky::CompressedGraph loaded;
+        TEST1(loaded.load(image) && loaded == graph && loaded.getBytes() == graph.getBytes(), loaded.getEdgeCount());
+
+        std::stringstream truncated(image.str().substr(0, image.str().size() / 2));
+        TEST1(!loaded.load(truncated) && loaded.getEndNode() == 0 && loaded.getEdgeCount() == 0, loaded.getEndNode());
+
+        // every corrupted byte of a small image is refused, or loads a graph that stays within itself
+        auto small = granky::Graph::create<granky::HashGraph>();
+        small->parseString("0 1 2\n0 2 3\n1 2 1\n2 0 7\n2 3 3\n3 1 2\n4 0 9\n");
+        std::stringstream smallImage;
+        granky::CompressedGraph(*small).save(smallImage);
+        const auto pristine = smallImage.str();
+        size_t refused = 0;
+        size_t strays = 0;
+
+        for(size_t i = 0; i < pristine.size(); ++i) {
+
+            auto corrupt = pristine;
+            corrupt[i] ^= 0x5a;
+            std::stringstream corrupted(corrupt);
+
+            if(!loaded.load(corrupted)) {
+
+                ++refused;
+                continue;
+            }
+
+            for(const auto& each : loaded.getEdges()) {
+
+                strays += !loaded.haveNode(each.from) || !loaded.haveNode(each.to) || !granky::Graph::isWeight(each.weight);
+            }
+        }
+
+        TEST1(refused > pristine.size() / 2 && strays == 0, refused);
+
+        // unweighted lists leave the weights out, and a ring's gaps fit in a byte
+        auto ring = granky::Graph::create<granky::HashGraph>();
+
+        for(granky::Graph::Node node = 0; node < 1000; ++node) {
+
+            ring->addEdge(node, (node + 1) % 1000, 1.0);
+            ring->addEdge(node, (node + 2) % 1000, 1.0);
+        }
+
+        granky::CompressedGraph compressedRing(*ring);
+        TEST1(compressedRing == *ring && compressedRing.getBitsPerEdge() < graph.getBitsPerEdge(), compressedRing.getBitsPerEdge());
+
+        // full groups decode the same with shifts as with shuffles, which are on wherever the processor has them
+#if defined(__x86_64__) || defined(__i386__)
+        TEST1(granky::CompressedGraph::isShuffled() == bool(__builtin_cpu_supports("ssse3")), granky::CompressedGraph::isShuffled());
+#endif
+        const auto shuffled = granky::CompressedGraph::isShuffled();
+
+        for(const bool shuffle : {false, true}) {
+
+            granky::CompressedGraph::setShuffled(shuffle);
+            onCompressed.execute();
+            TEST1(graph == *source && onCompressed.yieldWeight() == onSource.yieldWeight(), shuffle);
+            TEST1(granky::CompressedGraph::isShuffled() == (shuffle && shuffled), shuffle);
+        }
+
+        granky::CompressedGraph::setShuffled(shuffled);
+    }
+
+    {
+        // a grid under shuffled IDs, so that neighbours start far apart
+        auto grid = granky::Graph::create<granky::HashGraph>();
+        granky::GridGenerator(30, 30).generate(*grid, 1);
+        std::vector<granky::Graph::Node> shuffle(900);
+
+        for(granky::Graph::Node i = 0; i < 900; ++i) {
+
+            shuffle[i] = i;
+            std::swap(shuffle[i], shuffle[std::rand() % (i + 1)]);
+        }
+
+        const auto shuffled = granky::Permutation(shuffle).relabel<granky::HashGraph>(*grid);
+        TEST1(*shuffled != *grid && shuffled->getEdgeCount() == grid->getEdgeCount(), shuffled->getEdgeCount());
+
+        const auto before = granky::Permutation::getMeanLogGap(*shuffled);
+
+        for(const auto& permutation : {granky::Permutation::byDegree(*shuffled),
+                granky::Permutation::byCuthillMcKee(*shuffled), granky::Permutation::byCommunity(*shuffled)}) {
+
+            bool bijective = permutation.getNodeCount() == 900;
+
+            for(granky::Graph::Node node = 0; node < 900; ++node) {
+
+                bijective = bijective && permutation.restore(permutation.translate(node)) == node;
+            }
+
+            TEST1(bijective && permutation.translate(900) == -1 && permutation.translate(-1) == -1, permutation.getNodeCount());
+
+            const auto relabelled = permutation.relabel<granky::MatrixGraph>(*shuffled);
+            bool kept = relabelled->getEdgeCount() == shuffled->getEdgeCount();
+
+            shuffled->forEachEdge([&](granky::Graph::Node from, granky::Graph::Node to, granky::Graph::Weight weight) {
+
+                kept = kept && relabelled->haveEdge(permutation.translate(from), permutation.translate(to), weight);
+                return -1;
+            });
+
+            TEST1(kept, relabelled->getEdgeCount());
+
+            granky::AStar<granky::ZeroHeuristic> onShuffled;
+            granky::AStar<granky::ZeroHeuristic> onRelabelled;
+            onShuffled.init(shuffled.get());
+            onRelabelled.init(relabelled.get());
+            onShuffled.setSource(7);
+            onRelabelled.setSource(permutation.translate(7));
+            onShuffled.setSink(811);
+            onRelabelled.setSink(permutation.translate(811));
+            onShuffled.execute();
+            onRelabelled.execute();
+
+            const auto path = permutation.restore(onRelabelled.yieldSequence());
+            TEST1(onShuffled.yieldWeight() == onRelabelled.yieldWeight() && path.front().from == 7 && path.back().to == 811, path.size());
+        }
+
+        const auto banded = granky::Permutation::byCuthillMcKee(*shuffled).relabel<granky::HashGraph>(*shuffled);
+        const auto clustered = granky::Permutation::byCommunity(*shuffled).relabel<granky::HashGraph>(*shuffled);
+        TEST1(granky::Permutation::getMeanLogGap(*banded) < before * 0.6, before);
+        TEST1(granky::Permutation::getMeanLogGap(*clustered) < before * 0.6, granky::Permutation::getMeanLogGap(*clustered));
+
+        // two interleaved cliques, joined by one edge, come apart; the hub comes first by degree
+        auto cliques = granky::Graph::create<granky::HashGraph>();
+
+        for(granky::Graph::Node a = 0; a < 12; ++a) {
+
+            for(granky::Graph::Node b = a + 2; b < 12; b += 2) {
+
+                cliques->addDoubleEdge(a, b, 1.0);
+            }
+        }
+
+        cliques->addEdge(0, 1, 1.0);
+        cliques->addNode(20);
+
+        const auto communities = granky::Permutation::byCommunity(*cliques);
+        granky::Graph::Node lowest[] = {12, 12};
+        granky::Graph::Node highest[] = {0, 0};
+
+        for(granky::Graph::Node node = 0; node < 12; ++node) {
+
+            lowest[node % 2] = std::min(lowest[node % 2], communities.translate(node));
+            highest[node % 2] = std::max(highest[node % 2], communities.translate(node));
+        }
+
+        TEST1(highest[0] - lowest[0] == 5 && highest[1] - lowest[1] == 5, communities.translate(0));
+        TEST1(communities.getNodeCount() == 13 && granky::Graph::isNode(communities.translate(20)), communities.getNodeCount());
+
+        const auto degrees = granky::Permutation::byDegree(*cliques);
+        TEST1(degrees.restore(0) == 0 && degrees.restore(1) == 1 && degrees.restore(12) == 20, degrees.restore(0));
+        TEST1(degrees.relabel<granky::HashGraph>(*cliques)->haveNode(12), degrees.getNodeCount());
+    }
+
+    {
+        // a grid, a separate chain and a lone node, spread over three processes
+        auto graph = granky::Graph::create<granky::HashGraph>();
+        granky::GridGenerator(12, 12).generate(*graph, 1);
+
+        for(granky::Graph::Node node = 200; node < 209; ++node) {
+
+            graph->addEdge(node, node + 1, 1.0);
+        }
+
+        graph->addNode(300);
+
+        const auto hashed = granky::Partition::byHash(*graph, 3);
+        const auto ldg = granky::Partition::byLDG(*graph, 3);
+        const auto fennel = granky::Partition::byFennel(*graph, 3);
+        TEST1(ldg.getEdgeCut(*graph) < hashed.getEdgeCut(*graph) / 2, ldg.getEdgeCut(*graph));
+        TEST1(fennel.getEdgeCut(*graph) < hashed.getEdgeCut(*graph) / 2, fennel.getEdgeCut(*graph));
+        TEST1(ldg.getShardCount() == 3 && ldg.getSize(0) + ldg.getSize(1) + ldg.getSize(2) == 155, ldg.getSize(0));
+        TEST1(ldg.getSize(0) <= 55 && ldg.getSize(1) <= 55 && ldg.getSize(2) <= 55, ldg.getSize(2));
+
+        // a directory of this run's own, so that concurrent runs do not share shards
+        char directory[] = "/tmp/granky-gauntlet-XXXXXX";
+        TEST1(mkdtemp(directory), directory);
+        const std::string prefix = std::string(directory) + "/cluster";
+        granky::Partition read;
+        TEST1(ldg.write(*graph, prefix) && read.read(prefix), prefix);
+        TEST1(read.getShardCount() == 3 && read.getOwner(300) == ldg.getOwner(300) && read.getOwner(299) == -1, read.getOwner(300));
+
+        granky::Cluster cluster(3);
+        std::vector<granky::Cluster::Summary> summaries;
+        TEST1(cluster.breadthFirst(prefix, 0, summaries) && summaries.size() == 3, summaries.size());
+
+        // the distance to a grid cell is its row plus its column
+        auto total = granky::Cluster::combine(summaries);
+        TEST1(total.count == 144 && total.total == 1584 && total.depth == 22, total.total);
+        // every message has a 16 byte header, and each of the 39 nodes on a shard's border is sent once
+        TEST1(total.rounds == 23 && total.messages == 3 * 2 * 23, total.messages);
+        TEST1(total.bytes == total.messages * 16 + 39 * sizeof(granky::Graph::Node), total.bytes);
+
+        TEST1(cluster.colorComponents(prefix, summaries), summaries.size());
+        total = granky::Cluster::combine(summaries);
+        TEST1(total.count == 3 && total.total == 155, total.count);
+
+        TEST1(fennel.write(*graph, prefix) && cluster.breadthFirst(prefix, 200, summaries), prefix);
+        TEST1(granky::Cluster::combine(summaries).count == 10 && granky::Cluster::combine(summaries).total == 45, summaries[0].count);
+
+        // a cluster of the wrong size refuses the shards
+        TEST1(!granky::Cluster(2).colorComponents(prefix, summaries), summaries.size());
+
+        // a node of another shard reached in every round is still sent to its owner only once
+        auto chain = granky::Graph::create<granky::HashGraph>();
+        auto fan = granky::Graph::create<granky::HashGraph>();
+        chain->parseString("0 1\n1 2\n2 3\n3 4\n0 10\n");
+        fan->parseString("0 1\n1 2\n2 3\n3 4\n0 10\n1 10\n2 10\n3 10\n");
+        std::vector<granky::Graph::Node> owners(11, 0);
+        owners[10] = 1;
+        const granky::Partition split(owners, 2);
+
+        TEST1(split.write(*chain, prefix) && granky::Cluster(2).breadthFirst(prefix, 0, summaries), prefix);
+        const auto chainTotal = granky::Cluster::combine(summaries);
+        TEST1(split.write(*fan, prefix) && granky::Cluster(2).breadthFirst(prefix, 0, summaries), prefix);
+        const auto fanTotal = granky::Cluster::combine(summaries);
+        TEST1(fanTotal.count == 6 && fanTotal.bytes == chainTotal.bytes && fanTotal.rounds == chainTotal.rounds, fanTotal.bytes);
+        std::filesystem::remove_all(directory);
+    }
+
+    {
+        // many searches on one graph at once give what they give one at a time
+        auto graph = granky::Graph::create<granky::HashGraph>();
+        granky::GridGenerator(40, 40).generate(*graph, 1);
+        granky::Executor executor(4);
+        std::vector<granky::AStar<granky::ZeroHeuristic>> searches(64);
+        std::vector<granky::Query*> batch;
+
+        for(granky::Graph::Node i = 0; i < 64; ++i) {
+
+            searches[i].setSource(i * 25);
+            searches[i].setSink(1599 - i);
+            batch.push_back(&searches[i]);
+        }
+
+        auto futures = executor.submit(batch, *graph);
+        bool same = executor.getThreadCount() == 4;
+
+        for(granky::Graph::Node i = 0; i < 64; ++i) {
+
+            granky::AStar<granky::ZeroHeuristic> alone;
+            alone.init(graph.get());
+            alone.setSource(i * 25);
+            alone.setSink(1599 - i);
+            alone.execute();
+            same = same && futures[i].get() == &searches[i] && searches[i].yieldWeight() == alone.yieldWeight();
+        }
+
+        TEST1(same, executor.getStealCount());
+
+        // completions, plain tasks, and tasks that submit more tasks
+        std::atomic<int> done(0);
+        granky::ColorComponents colors;
+        executor.submit(colors, *graph, [&done](granky::Query& query) { done += query.yieldNode() == 1600; });
+
+        for(int i = 0; i < 100; ++i) {
+
+            executor.post([&executor, &done]() {
+
+                executor.post([&done]() { ++done; });
+            });
+        }
+
+        auto answer = executor.submit([]() { return 6 * 7; });
+        TEST1(answer.get() == 42, 42);
+        executor.wait();
+        TEST1(done == 101, done);
+    }
+
+    {
+        // requests pipelined in one buffer, the last of them cut short
+        auto graph = granky::Graph::create<granky::HashGraph>();
+        granky::GridGenerator(10, 10).generate(*graph, 1);
+        graph->addEdge(200, 201, 5.0);
+        granky::Service service(*graph, 2);
+
+        std::string input;
+        std::string output;
+        granky::Service::writeRequest(input, {1, granky::Service::PING, -1, -1});
+        granky::Service::writeRequest(input, {2, granky::Service::BFS, 0, 99});
+        granky::Service::writeRequest(input, {3, granky::Service::PATH, 0, 99});
+        granky::Service::writeRequest(input, {4, granky::Service::COMPONENT, 0, -1});
+        granky::Service::writeRequest(input, {5, granky::Service::COMPONENT, 201, -1});
+        granky::Service::writeRequest(input, {6, granky::Service::NEIGHBOURS, 0, -1});
+        granky::Service::writeRequest(input, {7, granky::Service::PATH, 0, 150});
+        granky::Service::writeRequest(input, {8, 42, 0, 0});
+        granky::Service::writeRequest(input, {9, granky::Service::PATH, 0, 200});
+
+        std::string rest;
+        granky::Service::writeRequest(rest, {10, granky::Service::STATS, -1, -1});
+        input += rest.substr(0, 7);
+        TEST1(service.serve(input, output) && input.size() == 7, input.size());
+
+        std::vector<granky::Service::Response> responses(10);
+
+        for(size_t i = 0; i < 9; ++i) {
+
+            TEST1(granky::Service::readResponse(output, responses[i]) && responses[i].id == i + 1, i);
+        }
+
+        TEST1(output.empty() && responses[0].results.empty() && responses[0].status == granky::Service::OK, output.size());
+        TEST1(responses[1].results.size() == 1 && responses[1].results[0].second == 18, responses[1].results.size());
+        TEST1(responses[2].results.size() == 19 && responses[2].results.back().first == 99 && responses[2].results.back().second == 18, responses[2].results.size());
+        TEST1(responses[3].results[0].second == 100 && responses[4].results[0].second == 2, responses[4].results[0].second);
+        TEST1(responses[3].results[0].first != responses[4].results[0].first && responses[5].results.size() == 2, responses[5].results.size());
+        TEST1(responses[6].status == granky::Service::UNKNOWN_NODE && responses[7].status == granky::Service::UNKNOWN_OP, responses[7].status);
+        TEST1(responses[8].status == granky::Service::OK && responses[8].results.empty(), responses[8].results.size());
+
+        input += rest.substr(7);
+        TEST1(service.serve(input, output) && input.empty() && granky::Service::readResponse(output, responses[9]), output.size());
+        TEST1(responses[9].id == 10 && responses[9].results.size() == 8 && responses[9].results[0].second == 9, responses[9].results[0].second);
+        TEST1(responses[9].results[6].second == 102 && responses[9].results[7].second == graph->getEdgeCount(), responses[9].results[6].second);
+
+        const auto stats = service.getStats();
+        TEST1(stats.requests == 10 && stats.batches == 2 && stats.median <= stats.p99 && stats.p99 <= stats.max, stats.requests);
+
+        // a frame of the wrong length is refused whole
+        std::string malformed("\x05\0\0\0\0\0\0\0\0", 9);
+        TEST1(!service.serve(malformed, output) && malformed.size() == 9 && output.empty(), malformed.size());
+    }
+
     {
         auto graph = granky::Graph::create<granky::HashGraph>(
                 "in/Fiset4.gky"